@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Sums any number of streams into one on a common timeline. Each sample
+// index stands for one instant on the steady clock at the mix rate; a
+// stream's chunk is added at the index of its playout time, so streams
+// whose jitter buffers release the same instant are heard together. Mixed
+// audio is emitted once it is `holdMs` old, giving streams released a
+// little late by their receive thread time to land.
+//
+// A stream stays contiguous from one chunk to the next and is only
+// realigned when its playout time jumps (resync, delay change) by more
+// than REALIGN_MS. Sums are clamped to full scale or passed through a
+// soft knee above KNEE; accumulation and both limiters have SSE2, AVX2 and
+// NEON kernels.
+//
+// Thread-safe: add() and flush() take a short lock, so several receive
+// threads can feed one mix and the sink sees a single producer.
+class AudioMixer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Summation {
+        Saturate,   // Clamp the sum to +-1.0
+        SoftClip    // Linear up to KNEE, then a tanh curve approaching +-1.0
+    };
+
+    // Per-stream state, owned by the stream and passed to add()
+    struct Input {
+        float gain = 1.0f;
+        int64_t cursor = 0;       // Mix index of the stream's next sample
+        bool aligned = false;
+    };
+
+    struct Stats {
+        uint64_t samplesOut = 0;
+        uint64_t samplesLate = 0;     // Arrived after their instant was emitted
+        uint64_t realigns = 0;
+    };
+
+    // Receives mixed float audio, full scale +-1.0, under the mixer's lock
+    using Sink = void (*)(const float* samples, size_t count, void* userData);
+
+    AudioMixer(int sampleRate, Summation summation, double holdMs = 10.0,
+               SimdKernel kernel = SimdKernel::Auto);
+
+    // Add int16 audio whose first sample plays at `playoutTime`
+    void add(Input& input, const int16_t* samples, size_t count, Clock::time_point playoutTime);
+    // Emit everything mixed up to `now` minus the hold time; returns samples emitted
+    size_t flush(Clock::time_point now, Sink sink, void* userData);
+    // When the audio mixed so far will all be due, if any is pending
+    bool nextFlushTime(Clock::time_point& when) const;
+
+    Stats getStats() const;
+    SimdKernel kernel() const { return kernel_; }
+
+    static constexpr float KNEE = 0.7f;          // About -3 dBFS
+
+private:
+    int64_t toIndex(Clock::time_point time) const;
+    void accumulate(const Input& input, const int16_t* samples, int64_t start, size_t count);
+
+    using AccumulateFunction = void (*)(const int16_t* in, float* mix, size_t count, float gain);
+    using FinalizeFunction = void (*)(float* mix, float* out, size_t count);
+
+    int sampleRate_;
+    Clock::time_point epoch_;
+    int64_t holdSamples_;
+    int64_t realignSamples_;
+    SimdKernel kernel_;
+    AccumulateFunction accumulate_;
+    FinalizeFunction finalize_;
+
+    mutable std::mutex mutex_;
+    std::vector<float> mix_;              // Ring of partial sums, indexed by mix index mod size
+    std::vector<float> out_;
+    int64_t readIndex_ = 0;               // Next index to emit
+    int64_t highWater_ = 0;               // One past the last index written
+    Stats stats_;
+
+    static constexpr size_t RING_SECONDS = 1;
+    static constexpr size_t FLUSH_BLOCK = 1024;
+    static constexpr double REALIGN_MS = 10.0;
+};
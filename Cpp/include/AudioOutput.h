@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Where the played audio goes. Device is the sound card via PortAudio; Null
+// and File run the same pull-based pipeline on headless machines, clocked by
+// a timer at the configured sample rate. Audio is converted from the
+// stream's rate to the output's before it is queued.
+struct AudioOutputConfig {
+    enum class Type {
+        Device,
+        Null,
+        File
+    };
+
+    // Sample format of the device stream; Auto prefers float32, the native
+    // format of most host APIs, and falls back to int16
+    enum class SampleFormat {
+        Auto,
+        Int16,
+        Float32
+    };
+
+    Type type = Type::Device;
+    std::string path;            // Raw 16-bit PCM target for Type::File
+    bool fallbackToNull = true;  // Use the null sink when there is no output device
+    int sampleRate = 0;          // Output rate in Hz; 0 uses the sink's native rate
+    SampleFormat sampleFormat = SampleFormat::Auto;
+    bool dither = false;         // TPDF dither when reducing to int16, instead of rounding
+};
+
+// A sink that periodically pulls mono float audio (full scale +-1.0) from a
+// render callback on its own (real-time or timer) thread, the way a sound
+// card does. Sinks that need int16 convert after rendering.
+class AudioOutput {
+public:
+    // Must fill all `frameCount` samples of `output`. `outputTime` is when the
+    // first sample will be heard, in seconds on the backend's clock.
+    using RenderCallback = void (*)(float* output, size_t frameCount, double outputTime, void* userData);
+
+    virtual ~AudioOutput() = default;
+
+    virtual bool open(int sampleRate, size_t framesPerBuffer, RenderCallback callback, void* userData) = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual void close() = 0;
+
+    virtual const char* name() const = 0;
+    // Format handed to the device or file: "float32" or "int16"
+    virtual const char* sampleFormat() const { return "float32"; }
+    // Rate the sink runs at without conversion by the host, or 0 when every
+    // rate is native (timer-clocked sinks)
+    virtual int nativeSampleRate() const { return 0; }
+};
+
+std::unique_ptr<AudioOutput> createAudioOutput(const AudioOutputConfig& config);
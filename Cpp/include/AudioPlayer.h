@@ -1,12 +1,17 @@
 #pragma once
 
-#include <portaudio.h>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
+#include "AudioOutput.h"
+#include "SPSCRingBuffer.h"
+#include "WavFileWriter.h"
+#include "StatsCounters.h"
+#include "Histogram.h"
+#include "ClockDriftEstimator.h"
+#include "FractionalResampler.h"
+#include "PolyphaseResampler.h"
+#include <atomic>
+#include <cmath>
 #include <vector>
 #include <string>
-#include <fstream>
 #include <memory>
 #include <cstdint>
 
@@ -15,43 +20,106 @@ public:
     AudioPlayer(int sampleRate = 16000, const std::string& saveFile = "");
     ~AudioPlayer();
 
+    // Must be called before initialize()
+    void setOutputConfig(const AudioOutputConfig& config) { outputConfig_ = config; }
+    // Resample playback to follow the sender's clock (default on)
+    void setDriftCompensation(bool enabled) { driftCompensation_ = enabled; }
+    // Playback gain in dB, applied in float; the saved WAV file is not affected
+    void setGainDb(double db) { gain_ = static_cast<float>(std::pow(10.0, db / 20.0)); }
+
     bool initialize();
     void shutdown();
     
     bool addAudioData(const std::vector<int16_t>& samples);
-    void flush();  // For saving remaining data to file
+    bool addAudioData(const int16_t* samples, size_t count);
+    // Float samples, full scale +-1.0
+    bool addAudioData(const float* samples, size_t count);
+    void flush();  // Hand buffered recording data to the writer thread
 
     bool isInitialized() const { return initialized_; }
     size_t getQueueSize() const;
+    // Rate of the output and the playback queue; valid after initialize()
+    int getOutputSampleRate() const { return outputRate_; }
+
+    struct Statistics {
+        uint64_t underruns = 0;          // Callbacks that ran out of queued audio
+        uint64_t samplesOverflowed = 0;  // Samples dropped because the queue was full
+        uint64_t queuedSamples = 0;      // At the output rate
+        double clockDriftPpm = 0.0;      // Sender clock against the output device
+        double playbackRatio = 1.0;      // Queued samples consumed per output sample
+    };
+
+    // Any thread
+    Statistics getStatistics() const;
+    // Audio callback run time (ns) and queue depth at its start (samples)
+    Histogram::Snapshot getCallbackDurationHistogram() const { return callbackDuration_.snapshot(); }
+    Histogram::Snapshot getQueueDepthHistogram() const { return queueDepth_.snapshot(); }
 
 private:
-    static int audioCallback(const void* inputBuffer, void* outputBuffer,
-                           unsigned long framesPerBuffer,
-                           const PaStreamCallbackTimeInfo* timeInfo,
-                           PaStreamCallbackFlags statusFlags,
-                           void* userData);
+    static void audioCallback(float* output, size_t frameCount, double outputTime, void* userData);
 
-    int fillAudioBuffer(int16_t* output, unsigned long frameCount);
+    void processBlock(float* samples, size_t count);
+    void enqueue(const float* samples, size_t count);
+    int fillAudioBuffer(float* output, unsigned long frameCount);
+    void updateDrift(double outputTime, size_t frameCount, bool starved);
+    void resetDrift();
 
-    int sampleRate_;
+    int sampleRate_;                     // Of the incoming stream
+    int outputRate_ = 0;
     std::string saveFile_;
     bool initialized_ = false;
 
-    PaStream* stream_ = nullptr;
-    
-    // Audio buffer management
-    std::queue<int16_t> audioQueue_;
-    mutable std::mutex queueMutex_;
-    std::condition_variable queueCondition_;
+    AudioOutputConfig outputConfig_;
+    std::unique_ptr<AudioOutput> output_;
     
-    static constexpr size_t MAX_QUEUE_SIZE = 48000;  // ~3 seconds at 16kHz
-    static constexpr int FRAMES_PER_BUFFER = 256;    // PortAudio buffer size
+    static constexpr size_t MAX_QUEUE_SIZE = 144000; // ~3 seconds at 48kHz
+    static constexpr int FRAMES_PER_BUFFER = 256;    // Output buffer size
+    static constexpr size_t RESAMPLE_BLOCK = 256;     // Output frames per resampler call
+    static constexpr size_t CONVERT_BLOCK = 1024;     // Input samples per processing block
+    static constexpr double MAX_RATIO_DEVIATION = 0.01;
+    static constexpr double DEPTH_SMOOTHING_S = 1.0;
+    static constexpr double DEPTH_LOCK_S = 2.0;       // Queue depth held from this far into a stream
+    static constexpr double DEPTH_CORRECTION_S = 10.0; // Time to work off a depth error
+
+    // Audio buffer management: written by the UDP thread, read by the
+    // PortAudio callback without locking
+    SPSCRingBuffer<float> audioQueue_{MAX_QUEUE_SIZE};
+
+    // Producer side processing in float: gain, then conversion from the
+    // stream to the output rate (null when they match)
+    float gain_ = 1.0f;
+    std::unique_ptr<PolyphaseResampler> converter_;
+    std::vector<float> converted_;
+    std::vector<float> floatBlock_;
+    std::vector<int16_t> pcmBlock_;      // WAV copy of float input
+
+    // Each written by one thread: underruns by the callback, overflows by the producer
+    alignas(64) StatCounter underruns_;
+    bool starved_ = true;                // Callback only: previous buffer was short
+    Histogram callbackDuration_;         // Callback only
+    Histogram queueDepth_;               // Callback only
+    alignas(64) StatCounter samplesOverflowed_;
+
+    // Clock drift compensation. The producer counts the samples it offers;
+    // the callback estimates their rate against the device clock and
+    // resamples so the queue stays at the depth it had early in the stream.
+    bool driftCompensation_ = true;
+    alignas(64) StatCounter samplesOffered_;
+    FractionalResampler resampler_{2 * RESAMPLE_BLOCK};
+    std::vector<float> resampleInput_ = std::vector<float>(2 * RESAMPLE_BLOCK);
+    ClockDriftEstimator drift_{30.0, 5.0};
+    double ratio_ = 1.0;                 // Callback only, as are the fields below
+    double framesRendered_ = 0.0;
+    double framesStreamed_ = 0.0;        // Since the queue last ran dry for a while
+    double framesStarved_ = 0.0;
+    double depthFiltered_ = 0.0;
+    double depthTarget_ = 0.0;
+    bool depthLocked_ = false;
+    std::atomic<double> clockDriftPpm_{0.0};
+    std::atomic<double> playbackRatio_{1.0};
 
-    // File saving
-    std::unique_ptr<std::ofstream> wavFile_;
-    std::vector<int16_t> fileBuffer_;
+    // File saving, written on its own thread with bounded memory
+    std::unique_ptr<WavFileWriter> wavWriter_;
     void initializeWavFile();
-    void writeWavHeader();
     void finalizeWavFile();
-    uint32_t totalSamplesWritten_ = 0;
 };
\ No newline at end of file
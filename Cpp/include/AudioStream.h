@@ -0,0 +1,62 @@
+#pragma once
+
+#include "PacketParser.h"
+#include "JitterBuffer.h"
+#include "PlayoutDelayController.h"
+#include "StatsCounters.h"
+#include "AudioMixer.h"
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <netinet/in.h>
+#endif
+
+// Per-sender counters, published by the receiver thread
+struct StreamCounters {
+    uint64_t packetsReceived = 0;
+    uint64_t packetsDropped = 0;
+    uint64_t packetsOutOfOrder = 0;
+    uint64_t packetsLate = 0;
+    uint64_t packetsDuplicate = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t samplesConcealed = 0;
+    double jitterMs = 0.0;
+    double targetDelayMs = 0.0;
+};
+
+struct StreamStatistics : StreamCounters {
+    std::string source;                // "address:port"
+};
+
+// Independent receive pipeline for one sender: its own sequence tracking,
+// jitter estimate, jitter buffer and optional delay controller. Packet
+// buffers come from `pool` when one is given.
+struct AudioStream {
+    AudioStream(const sockaddr_in& source, int sampleRate,
+                const JitterBuffer::Config& jitterConfig, bool adaptiveDelay,
+                PacketBufferPool* pool = nullptr);
+
+    // Pack IPv4 address and port into one integer key
+    static uint64_t makeKey(const sockaddr_in& source);
+    static sockaddr_in addressFromKey(uint64_t key);
+    static std::string formatAddress(const sockaddr_in& source);
+
+    // Publish the pipeline's counters; receiver thread only, lock-free
+    void publishStatistics();
+    // Consistent copy of the last published counters; any thread
+    StreamStatistics getStatistics() const;
+
+    sockaddr_in source;
+    PacketParser parser;
+    JitterBuffer jitterBuffer;
+    std::unique_ptr<PlayoutDelayController> delayController;
+    JitterBuffer::Clock::time_point lastActivity;
+    uint64_t bytesReceived = 0;
+    std::string name;                  // "address:port"
+    AudioMixer::Input mixInput;        // Gain and position in the mix
+    SeqLock<StreamCounters> counters;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+// Estimates how fast one clock runs against another from (time, position)
+// pairs, e.g. sender sample timestamps against local arrival times, as the
+// slope of an exponentially weighted least-squares line. Old points fade
+// out with the given time constant, so the estimate follows slow
+// temperature drift while averaging out network and scheduling jitter.
+class ClockDriftEstimator {
+public:
+    explicit ClockDriftEstimator(double timeConstantSeconds = 60.0, double minSpanSeconds = 5.0);
+
+    // `time` in seconds on the reference clock; `position` in any unit
+    void update(double time, double position);
+    void reset();
+
+    // True once the points span minSpanSeconds
+    bool isValid() const;
+    // Position units per reference second; 0 until valid
+    double rate() const;
+
+private:
+    void recenter(double dx, double dy);
+
+    double timeConstant_;
+    double minSpan_;
+
+    bool started_ = false;
+    double firstTime_ = 0.0;
+    double lastTime_ = 0.0;
+    double originTime_ = 0.0;      // Sums are kept relative to this point for precision
+    double originPosition_ = 0.0;
+
+    // Weighted sums of 1, x, y, x^2 and xy
+    double sw_ = 0.0;
+    double sx_ = 0.0;
+    double sy_ = 0.0;
+    double sxx_ = 0.0;
+    double sxy_ = 0.0;
+};
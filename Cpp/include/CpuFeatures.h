@@ -0,0 +1,110 @@
+#pragma once
+
+// SIMD support for the DSP kernels. Instruction sets every target CPU has
+// (SSE2 on x86-64, NEON on 64-bit ARM) are used unconditionally; AVX2 kernels
+// are compiled with a per-function target attribute and chosen at runtime
+// with cpuHasAvx2(), so the build needs no -m flags.
+
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define AUDIO_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_SIMD_SSE2 1
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define AUDIO_SIMD_NEON 1
+#include <arm_neon.h>
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define AUDIO_SIMD_NEON64 1
+#endif
+#endif
+
+// GCC and Clang compile AVX2 functions for their own target only; MSVC
+// accepts the intrinsics without flags
+#if defined(AUDIO_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AUDIO_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define AUDIO_TARGET_AVX2
+#endif
+
+// True when the CPU and OS support AVX2 and FMA
+inline bool cpuHasAvx2() {
+#if defined(AUDIO_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(AUDIO_SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 6) != 6) return false;  // OS saves YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+// Kernel sets the DSP classes can be asked for, e.g. to benchmark them
+// against each other. Auto picks the best available.
+enum class SimdKernel {
+    Auto,
+    Scalar,
+    Sse2,
+    Avx2,
+    Neon
+};
+
+inline bool simdKernelAvailable(SimdKernel kernel) {
+    switch (kernel) {
+    case SimdKernel::Auto:
+    case SimdKernel::Scalar:
+        return true;
+    case SimdKernel::Sse2:
+#ifdef AUDIO_SIMD_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case SimdKernel::Avx2:
+        return cpuHasAvx2();
+    case SimdKernel::Neon:
+#ifdef AUDIO_SIMD_NEON
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+// Resolves Auto, and any kernel this CPU lacks, to the best available one
+inline SimdKernel resolveSimdKernel(SimdKernel kernel) {
+    if (kernel != SimdKernel::Auto && simdKernelAvailable(kernel)) return kernel;
+    static const SimdKernel best = [] {
+        for (SimdKernel candidate : {SimdKernel::Avx2, SimdKernel::Neon, SimdKernel::Sse2}) {
+            if (simdKernelAvailable(candidate)) return candidate;
+        }
+        return SimdKernel::Scalar;
+    }();
+    return best;
+}
+
+inline const char* simdKernelName(SimdKernel kernel) {
+    switch (kernel) {
+    case SimdKernel::Auto: return "auto";
+    case SimdKernel::Scalar: return "scalar";
+    case SimdKernel::Sse2: return "sse2";
+    case SimdKernel::Avx2: return "avx2";
+    case SimdKernel::Neon: return "neon";
+    }
+    return "unknown";
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <netinet/in.h>
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+#endif
+
+// Receives datagrams from a bound UDP socket into preallocated buffers.
+// With a batch size above one on Linux, a single recvmmsg call drains up to
+// that many queued datagrams; elsewhere it falls back to one recvfrom per call.
+// On Linux sockets with SO_TIMESTAMPNS enabled, each datagram's arrival time
+// is the kernel receive timestamp rather than the time this thread woke up.
+class DatagramReceiver {
+public:
+    using Clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+    using SocketHandle = uintptr_t;
+#else
+    using SocketHandle = int;
+#endif
+
+    struct Datagram {
+        const uint8_t* data = nullptr;
+        size_t length = 0;
+        sockaddr_in source{};
+        Clock::time_point arrival;        // Kernel timestamp mapped onto Clock when available
+        bool kernelTimestamp = false;
+    };
+
+    explicit DatagramReceiver(size_t batchSize = 1, size_t bufferSize = 4096);
+
+    // Receive at least one datagram, blocking according to the socket's mode
+    // and timeout. Returns the number received, 0 on timeout or when a
+    // non-blocking socket is empty, -1 on error.
+    int receive(SocketHandle socket);
+
+    const Datagram& operator[](size_t index) const { return datagrams_[index]; }
+    size_t batchSize() const { return batchSize_; }
+
+    static bool batchingSupported();
+
+    // Ask the kernel to timestamp incoming datagrams (SO_TIMESTAMPNS, Linux only)
+    static bool enableKernelTimestamps(SocketHandle socket);
+
+private:
+    size_t batchSize_;
+    size_t bufferSize_;
+    std::vector<uint8_t> storage_;        // batchSize_ buffers of bufferSize_ bytes
+    std::vector<Datagram> datagrams_;
+
+#ifdef __linux__
+    void resetMessage(size_t index);
+    void extractTimestamp(size_t index, Clock::time_point now, int64_t realtimeToSteadyNs);
+
+    std::vector<mmsghdr> messages_;
+    std::vector<iovec> iovecs_;
+    std::vector<uint64_t> control_;       // Per-message cmsg space, 8-byte aligned
+    size_t controlWords_ = 0;
+#endif
+};
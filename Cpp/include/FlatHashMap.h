@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <functional>
+
+// Open-addressing hash map with linear probing and backward-shift deletion.
+// Keys and values live inline in one contiguous slot array, so a lookup is
+// usually a single cache line and there are no tombstones to degrade probe
+// lengths as streams come and go. Capacity is a power of two and the table
+// grows at 75% load. Not thread-safe.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap {
+public:
+    explicit FlatHashMap(size_t initialCapacity = 16) {
+        size_t capacity = 16;
+        while (capacity < initialCapacity) capacity <<= 1;
+        slots_.resize(capacity);
+        occupied_.assign(capacity, 0);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    Value* find(const Key& key) {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = indexFor(key); occupied_[i]; i = (i + 1) & mask) {
+            if (slots_[i].first == key) return &slots_[i].second;
+        }
+        return nullptr;
+    }
+
+    // Insert a default-constructed value if the key is absent; the bool is
+    // true when an insertion happened. Pointers are invalidated by later inserts.
+    std::pair<Value*, bool> findOrInsert(const Key& key) {
+        if (Value* existing = find(key)) {
+            return {existing, false};
+        }
+        if ((size_ + 1) * 4 > slots_.size() * 3) {
+            rehash(slots_.size() * 2);
+        }
+        size_t mask = slots_.size() - 1;
+        size_t i = indexFor(key);
+        while (occupied_[i]) i = (i + 1) & mask;
+        slots_[i].first = key;
+        slots_[i].second = Value{};
+        occupied_[i] = 1;
+        size_++;
+        return {&slots_[i].second, true};
+    }
+
+    bool erase(const Key& key) {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = indexFor(key); occupied_[i]; i = (i + 1) & mask) {
+            if (slots_[i].first == key) {
+                eraseAt(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Visit every entry as f(const Key&, Value&)
+    template <typename F>
+    void forEach(F&& f) {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (occupied_[i]) f(static_cast<const Key&>(slots_[i].first), slots_[i].second);
+        }
+    }
+
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (occupied_[i]) f(slots_[i].first, slots_[i].second);
+        }
+    }
+
+    // Remove every entry for which pred(const Key&, Value&) is true; returns the count
+    template <typename F>
+    size_t eraseIf(F&& pred) {
+        size_t removed = 0;
+        size_t i = 0;
+        while (i < slots_.size()) {
+            // Backward shift may move an unvisited entry into slot i, so
+            // re-examine the same slot after an erase
+            if (occupied_[i] && pred(static_cast<const Key&>(slots_[i].first), slots_[i].second)) {
+                eraseAt(i);
+                removed++;
+            } else {
+                i++;
+            }
+        }
+        return removed;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (occupied_[i]) slots_[i].second = Value{};
+        }
+        occupied_.assign(slots_.size(), 0);
+        size_ = 0;
+    }
+
+private:
+    size_t indexFor(const Key& key) const {
+        // Finalize the hash so identity hashes of integers spread over the mask
+        uint64_t h = static_cast<uint64_t>(Hash{}(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h) & (slots_.size() - 1);
+    }
+
+    void eraseAt(size_t hole) {
+        size_t mask = slots_.size() - 1;
+        size_t next = (hole + 1) & mask;
+        while (occupied_[next]) {
+            // Move the entry back if the hole lies between its home slot and it
+            size_t home = indexFor(slots_[next].first);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots_[hole] = std::move(slots_[next]);
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        slots_[hole].second = Value{};
+        occupied_[hole] = 0;
+        size_--;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<std::pair<Key, Value>> oldSlots(capacity);
+        std::vector<uint8_t> oldOccupied(capacity, 0);
+        oldSlots.swap(slots_);
+        oldOccupied.swap(occupied_);
+
+        size_t mask = capacity - 1;
+        for (size_t j = 0; j < oldSlots.size(); ++j) {
+            if (!oldOccupied[j]) continue;
+            size_t i = indexFor(oldSlots[j].first);
+            while (occupied_[i]) i = (i + 1) & mask;
+            slots_[i] = std::move(oldSlots[j]);
+            occupied_[i] = 1;
+        }
+    }
+
+    std::vector<std::pair<Key, Value>> slots_;
+    std::vector<uint8_t> occupied_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Streaming resampler for ratios close to one, used to absorb clock drift:
+// consumes `ratio` input samples per output sample with 4-point cubic
+// (Catmull-Rom) interpolation, so the ratio can change between calls
+// without discontinuities. At a ratio of exactly 1 the output is the input,
+// unchanged. Holds up to three input samples between calls. Allocates only
+// at construction; safe for the audio callback.
+class FractionalResampler {
+public:
+    // `maxInput`: most input samples passed to one process() call
+    explicit FractionalResampler(size_t maxInput);
+
+    // Input samples process() needs to produce `frames` outputs at `ratio`
+    size_t inputNeeded(size_t frames, double ratio) const;
+
+    // Takes all of `input` (up to maxInput) and writes up to `frames`
+    // outputs; returns the number written, fewer only when input ran out
+    size_t process(const float* input, size_t count, float* output, size_t frames, double ratio);
+
+    // Input samples taken but not yet fully played
+    size_t buffered() const { return fill_; }
+    void reset();
+
+private:
+    std::vector<float> fifo_;
+    size_t fill_ = 0;
+    double position_ = 1.0;   // Read position in fifo_; fifo_[position_ - 1] is kept for interpolation
+};
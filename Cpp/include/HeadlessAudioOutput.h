@@ -0,0 +1,80 @@
+#pragma once
+
+#include "AudioOutput.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pulls a buffer from the render callback every framesPerBuffer / sampleRate
+// seconds on a dedicated thread, sleeping to absolute deadlines so the
+// average rate matches a sound card's and timer slop does not accumulate.
+// Subclasses must stop() in their own destructor, while consume() is still theirs.
+class ClockedAudioOutput : public AudioOutput {
+public:
+    ~ClockedAudioOutput() override;
+
+    bool open(int sampleRate, size_t framesPerBuffer, RenderCallback callback, void* userData) override;
+    bool start() override;
+    void stop() override;
+    void close() override;
+
+    // Buffers rendered since start()
+    uint64_t getBuffersRendered() const { return buffersRendered_.load(std::memory_order_relaxed); }
+
+protected:
+    // Called on the clock thread with each rendered buffer
+    virtual void consume(const float* samples, size_t count) = 0;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void clockThread();
+
+    int sampleRate_ = 0;
+    size_t framesPerBuffer_ = 0;
+    RenderCallback callback_ = nullptr;
+    void* userData_ = nullptr;
+
+    std::vector<float> buffer_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> buffersRendered_{0};
+};
+
+// Renders and discards; for benchmarks and soak tests without a sound card
+class NullAudioOutput : public ClockedAudioOutput {
+public:
+    ~NullAudioOutput() override { stop(); }
+
+    const char* name() const override { return "null"; }
+
+protected:
+    void consume(const float* samples, size_t count) override;
+};
+
+// Writes exactly what a sound card would have played, as raw 16-bit PCM
+class FileAudioOutput : public ClockedAudioOutput {
+public:
+    explicit FileAudioOutput(const std::string& path, bool dither = false);
+    ~FileAudioOutput() override { close(); }
+
+    bool open(int sampleRate, size_t framesPerBuffer, RenderCallback callback, void* userData) override;
+    void close() override;
+
+    const char* name() const override { return "file"; }
+    const char* sampleFormat() const override { return "int16"; }
+
+protected:
+    void consume(const float* samples, size_t count) override;
+
+private:
+    std::string path_;
+    bool dither_;
+    uint32_t ditherSeed_ = 0x9E3779B9;
+    std::vector<int16_t> pcm_;
+    std::unique_ptr<std::ofstream> file_;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fixed-memory log-linear histogram of non-negative integer values, in the
+// style of HdrHistogram: values below 2 * SUB_BUCKETS are counted exactly,
+// larger ones in SUB_BUCKETS linear steps per power of two, so every bucket
+// is within 1/SUB_BUCKETS (about 6%) of the value it holds. Values above
+// MAX_VALUE land in the last bucket.
+//
+// Like StatCounter, one writer thread records with relaxed loads and stores
+// and never waits; any thread may take a snapshot. A snapshot taken during a
+// record() may miss that one value.
+class Histogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_SHIFT = 36;  // Up to ~2^40, e.g. 18 minutes in ns
+    static constexpr size_t BUCKETS = (MAX_SHIFT + 2) * SUB_BUCKETS;
+    static constexpr uint64_t MAX_VALUE = ((2 * SUB_BUCKETS) << MAX_SHIFT) - 1;
+
+    // Plain copy of the counts; merge and query off the hot path
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        void merge(const Snapshot& other);
+        // Smallest recorded bucket value at or above `quantile` (0..1) of the count
+        uint64_t percentile(double quantile) const;
+        double mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+    };
+
+    // Writer thread only
+    void record(uint64_t value) {
+        if (value > MAX_VALUE) value = MAX_VALUE;
+        increment(counts_[bucketIndex(value)], 1);
+        increment(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread
+    Snapshot snapshot() const;
+
+    static size_t bucketIndex(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) return static_cast<size_t>(value);
+        unsigned shift = highestBit(value) - SUB_BUCKET_BITS;
+        return static_cast<size_t>(shift * SUB_BUCKETS + (value >> shift));
+    }
+    // Highest value that falls in bucket `index`
+    static uint64_t bucketValue(size_t index);
+
+private:
+    static void increment(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static unsigned highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned bit = 0;
+        while (value >>= 1) ++bit;
+        return bit;
+#endif
+    }
+
+    std::atomic<uint64_t> counts_[BUCKETS] = {};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// One-line summaries of a snapshot, values divided by `scale` (e.g. 1e6 to
+// print nanoseconds as milliseconds)
+std::string formatHistogramText(const Histogram::Snapshot& snapshot, double scale, const char* unit);
+std::string formatHistogramJson(const Histogram::Snapshot& snapshot, double scale);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "PacketParser.h"
+#include "PacketBufferPool.h"
+#include "Histogram.h"
+#include "PacketLossConcealer.h"
+#include "ClockDriftEstimator.h"
+#include <map>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+
+// Reorders packets by sampleTimestamp and releases contiguous audio at a
+// fixed playout delay behind the first packet's arrival, paced at the
+// sender's sample rate as measured from arrivals. Missing ranges whose
+// playout time has passed are synthesized by a PacketLossConcealer, which
+// also cross-fades back into the audio that follows. Samples are held in
+// packet buffers from a shared pool and map nodes are recycled, so
+// steady-state operation does not allocate. Not thread-safe; owned by the
+// UDP receiver thread.
+class JitterBuffer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    using Concealment = PacketLossConcealer::Mode;
+
+    struct Config {
+        double targetDelayMs = 60.0;      // Playout delay behind arrival
+        double reorderWindowMs = 500.0;   // Max distance ahead of the playout cursor
+        Concealment concealment = Concealment::Waveform;
+        bool trackSenderClock = true;     // Release at the measured sender rate
+    };
+
+    struct Stats {
+        uint64_t packetsInserted = 0;
+        uint64_t packetsLate = 0;         // Arrived after their audio was played out
+        uint64_t packetsDuplicate = 0;
+        uint64_t samplesReleased = 0;
+        uint64_t samplesConcealed = 0;
+        uint64_t resyncs = 0;             // Timestamp jumps outside the reorder window
+        double senderRate = 0.0;          // Measured sender sample rate, once known
+    };
+
+    explicit JitterBuffer(int sampleRate);
+    JitterBuffer(int sampleRate, const Config& config);
+
+    // Buffers for insert(const AudioPacketView&) come from `pool` (which must
+    // outlive this buffer) instead of the heap
+    void setBufferPool(PacketBufferPool* pool) { pool_ = pool; }
+    // Record each packet's receive-to-release time, in ns, into `histogram`;
+    // it must outlive this buffer and have no other writer
+    void setLatencyHistogram(Histogram* histogram) { latencyHistogram_ = histogram; }
+
+    // Slot a packet by its sampleTimestamp, copying its samples out of the
+    // view; returns false if it was discarded
+    bool insert(const AudioPacketView& packet, Clock::time_point arrival);
+    // Slot a packet, taking over its buffer without copying
+    bool insert(AudioPacket&& packet, Clock::time_point arrival);
+
+    // Next contiguous run of audio whose playout time is <= now, pointing into
+    // the buffer's own storage and valid until the next call; returns 0 when
+    // nothing is due. Call repeatedly to release everything that is due.
+    size_t releaseChunk(Clock::time_point now, const int16_t*& samples);
+    // Same, also giving the playout time of the chunk's first sample
+    size_t releaseChunk(Clock::time_point now, const int16_t*& samples, Clock::time_point& chunkTime);
+
+    // Append all audio whose playout time is <= now to `out`; returns samples appended
+    size_t release(Clock::time_point now, std::vector<int16_t>& out);
+
+    // Playout time of the next held audio, if any
+    std::optional<Clock::time_point> nextReleaseTime() const;
+
+    // Append everything held, filling gaps, regardless of playout time
+    size_t drain(std::vector<int16_t>& out);
+
+    // Shrinking skips queued audio, cross-faded, to cut latency; growing
+    // pauses release
+    void setTargetDelay(double ms);
+    double getTargetDelayMs() const { return config_.targetDelayMs; }
+
+    size_t getBufferedPackets() const { return packets_.size(); }
+    const Stats& getStats() const { return stats_; }
+    void reset();
+
+private:
+    struct Entry {
+        PacketBuffer samples;
+        Clock::time_point arrival;
+    };
+    using PacketMap = std::map<int64_t, Entry>;
+
+    int64_t unwrapTimestamp(uint32_t timestamp) const;
+    Clock::time_point playoutTime(int64_t timestamp) const;
+    void anchor(int64_t timestamp, Clock::time_point arrival);
+    void trackSenderClock(int64_t timestamp, Clock::time_point arrival);
+    bool admit(uint32_t sampleTimestamp, size_t sampleCount, Clock::time_point arrival,
+               int64_t& timestamp, size_t& skip);
+    void store(int64_t timestamp, PacketBuffer&& samples, Clock::time_point arrival);
+    void recycle(PacketMap::iterator it);
+    size_t generateConcealment(size_t count);
+
+    int sampleRate_;
+    Config config_;
+    Stats stats_;
+    PacketBufferPool* pool_ = nullptr;
+    Histogram* latencyHistogram_ = nullptr;
+
+    // Keyed by unwrapped (64-bit) sample timestamp
+    PacketMap packets_;
+    std::vector<PacketMap::node_type> spareNodes_;  // Extracted nodes kept for reuse (without buffers)
+    PacketMap::node_type released_;                 // Backs the last releaseChunk()
+    std::vector<int16_t> concealBuffer_;            // Backs concealment chunks
+    PacketLossConcealer concealer_;
+
+    bool started_ = false;
+    int64_t cursor_ = 0;                  // Next sample timestamp to release
+    int64_t anchorTimestamp_ = 0;
+    Clock::time_point anchorTime_;
+    Clock::duration targetDelay_;
+    int64_t reorderWindowSamples_ = 0;
+
+    // Release runs at the measured sender rate rather than the nominal one,
+    // so a sender clock a few hundred ppm off does not slowly drain or fill
+    // the buffer. The rate changes only at re-anchoring, about once a second.
+    ClockDriftEstimator senderClock_{60.0, 5.0};
+    Clock::time_point clockOrigin_;
+    Clock::time_point lastRateUpdate_;
+    double playoutRate_;
+
+    static constexpr int CONCEAL_CHUNK_MS = 20;    // Longest concealment chunk
+    static constexpr double MAX_RATE_DEVIATION = 0.01;
+    static constexpr int RATE_UPDATE_MS = 1000;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "MPSCQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <thread>
+
+// Asynchronous, rate-limited logging for the packet and audio hot paths.
+//
+// log() records a fixed-size event (type, time and up to three integers) in a
+// lock-free queue and returns; a background thread turns records into text
+// and writes them to the console. Each event type may log at most
+// RATE_LIMIT_PER_SECOND records per second; further ones are only counted and
+// reported with the next record of that type that gets through. If the queue
+// is full, or the logger was never started, records are dropped and counted.
+class Logger {
+public:
+    enum class Event : uint8_t {
+        PacketsDropped,        // count, first missing seq, last missing seq
+        PacketOutOfOrder,      // seq, expected seq
+        InvalidPacketLength,   // payload bytes
+        AudioOverflow,         // samples dropped
+        StreamAdded,           // IPv4 address (host order), port
+        StreamRemoved,         // IPv4 address (host order), port
+        StreamPlaying,         // IPv4 address (host order), port
+        Count
+    };
+
+    static Logger& instance();
+    ~Logger();
+
+    void start();
+    // Writes out everything queued before returning
+    void stop();
+
+    // Lock-free and allocation-free; callable from any thread
+    void log(Event event, int64_t a = 0, int64_t b = 0, int64_t c = 0);
+
+    uint64_t getSuppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+    uint64_t getDropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Record {
+        Event event;
+        int64_t a;
+        int64_t b;
+        int64_t c;
+        uint64_t suppressedBefore;  // Records of this type rate-limited since the last one
+    };
+
+    // Per-event fixed one-second window
+    struct RateLimit {
+        std::atomic<int64_t> windowStart{0};
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> suppressed{0};
+    };
+
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+    static constexpr uint32_t RATE_LIMIT_PER_SECOND = 10;
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    Logger();
+
+    bool admit(RateLimit& limit, uint64_t& suppressedBefore);
+    void writerThread();
+    size_t writeQueued();
+    static void format(const Record& record);
+    static void formatAddress(std::ostream& out, int64_t address, int64_t port);
+
+    MPSCQueue<Record> queue_{QUEUE_CAPACITY};
+    RateLimit limits_[static_cast<size_t>(Event::Count)];
+    std::atomic<uint64_t> suppressed_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+};
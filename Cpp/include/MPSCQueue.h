@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// Fixed-capacity multi-producer/single-consumer queue (Vyukov's bounded
+// queue). Each slot carries a sequence number that tells producers and the
+// consumer whose turn it is, so tryPush() and tryPop() are lock-free and never
+// allocate. tryPush() fails instead of waiting when the queue is full.
+template <typename T>
+class MPSCQueue {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "MPSCQueue elements are copied into fixed slots");
+
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    explicit MPSCQueue(size_t capacity)
+        : mask_(roundUpPow2(capacity) - 1), slots_(new Slot[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Any thread; returns false if the queue is full
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & mask_];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only; returns false if the queue is empty
+    bool tryPop(T& value) {
+        Slot& slot = slots_[dequeuePos_ & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != dequeuePos_ + 1) {
+            return false;
+        }
+        value = slot.value;
+        slot.sequence.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+        dequeuePos_++;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUpPow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_{0};
+    alignas(CACHE_LINE_SIZE) size_t dequeuePos_ = 0;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Minimal HTTP/1.0 server for metrics scraping. Answers GET /metrics with the
+// text returned by `render` (Prometheus exposition format) on its own thread,
+// one connection at a time, so a slow or stuck client can only delay other
+// scrapers. Listens on loopback only.
+class MetricsServer {
+public:
+    using RenderFunction = std::function<std::string()>;
+
+    explicit MetricsServer(RenderFunction render);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    bool start(int port);
+    void stop();
+
+    uint64_t getRequestsServed() const { return requestsServed_.load(std::memory_order_relaxed); }
+
+private:
+#ifdef _WIN32
+    using SocketHandle = uintptr_t;
+#else
+    using SocketHandle = int;
+#endif
+
+    void serverThread();
+    void handleConnection(SocketHandle client);
+    void closeListenSocket();
+
+    static constexpr int ACCEPT_TIMEOUT_MS = 200;   // Shutdown latency
+    static constexpr int CLIENT_TIMEOUT_MS = 1000;
+    static constexpr size_t MAX_REQUEST_SIZE = 4096;
+
+    RenderFunction render_;
+#ifdef _WIN32
+    SocketHandle listenSocket_ = 0;
+#else
+    SocketHandle listenSocket_ = -1;
+#endif
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> requestsServed_{0};
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+class PacketBufferPool;
+
+// Move-only owner of a packet's samples. A pooled buffer goes back to its
+// pool's free list when the handle is destroyed or reset; a buffer allocated
+// because the pool was empty is simply freed.
+class PacketBuffer {
+public:
+    PacketBuffer() = default;
+    PacketBuffer(PacketBuffer&& other) noexcept;
+    PacketBuffer& operator=(PacketBuffer&& other) noexcept;
+    PacketBuffer(const PacketBuffer&) = delete;
+    PacketBuffer& operator=(const PacketBuffer&) = delete;
+    ~PacketBuffer() { reset(); }
+
+    int16_t* data() { return data_; }
+    const int16_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    int16_t& operator[](size_t i) { return data_[i]; }
+    const int16_t& operator[](size_t i) const { return data_[i]; }
+    int16_t* begin() { return data_; }
+    int16_t* end() { return data_ + size_; }
+    const int16_t* begin() const { return data_; }
+    const int16_t* end() const { return data_ + size_; }
+
+    // Shrink or grow within capacity(); never reallocates
+    void resize(size_t size) { size_ = size < capacity_ ? size : capacity_; }
+
+    // Drop the first `count` samples
+    void trimFront(size_t count);
+
+    // Return the storage and leave the handle empty
+    void reset();
+
+private:
+    friend class PacketBufferPool;
+
+    static constexpr uint32_t NOT_POOLED = ~0u;
+
+    PacketBufferPool* pool_ = nullptr;
+    int16_t* storage_ = nullptr;   // Start of the buffer as handed out
+    int16_t* data_ = nullptr;      // First live sample (after trimFront)
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    uint32_t index_ = NOT_POOLED;
+};
+
+// Fixed-size packet buffers carved from preallocated slabs, handed out
+// through a lock-free free list (a Treiber stack of indices whose head carries
+// a version tag against ABA). Any thread may acquire and release. The pool
+// starts with one slab of `bufferCount` buffers and reserve() adds slabs, up
+// to `maxBufferCount`, off the packet path. When the pool is exhausted, or a
+// request is larger than a pooled buffer, acquire() falls back to the heap
+// and counts it, so an undersized pool costs allocations rather than audio.
+class PacketBufferPool {
+public:
+    // A `maxBufferCount` of 0 fixes the pool at `bufferCount`
+    PacketBufferPool(size_t bufferSamples, size_t bufferCount, size_t maxBufferCount = 0);
+    PacketBufferPool(const PacketBufferPool&) = delete;
+    PacketBufferPool& operator=(const PacketBufferPool&) = delete;
+
+    // A buffer holding `samples` samples (contents unspecified)
+    PacketBuffer acquire(size_t samples);
+
+    // A heap buffer, for callers without a pool
+    static PacketBuffer allocate(size_t samples);
+
+    // Grow by whole slabs until the pool holds at least `bufferCount`
+    // buffers (capped at the maximum); allocates, so not for the packet path
+    void reserve(size_t bufferCount);
+
+    size_t bufferSamples() const { return bufferSamples_; }
+    size_t bufferCount() const { return bufferCount_.load(std::memory_order_relaxed); }
+    size_t available() const { return available_.load(std::memory_order_relaxed); }
+    uint64_t getFallbackAllocations() const { return fallbacks_.load(std::memory_order_relaxed); }
+
+private:
+    friend class PacketBuffer;
+
+    static constexpr uint32_t EMPTY = ~0u;
+
+    void release(uint32_t index);
+    void addSlab();
+    int16_t* bufferAt(uint32_t index) const;
+
+    size_t bufferSamples_;
+    size_t slabBuffers_;
+    size_t maxSlabs_;
+    std::atomic<size_t> bufferCount_{0};
+    // Slab k holds buffers [k * slabBuffers_, (k + 1) * slabBuffers_); a slab
+    // is written before its buffers are published through head_
+    std::unique_ptr<std::unique_ptr<int16_t[]>[]> slabs_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;   // Free-list links, sized for every slab
+    std::mutex growMutex_;                            // Serializes reserve()
+
+    // Low 32 bits: index of the first free buffer; high 32 bits: version tag
+    std::atomic<uint64_t> head_{EMPTY};
+    std::atomic<size_t> available_{0};
+    std::atomic<uint64_t> fallbacks_{0};
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Synthesizes audio for missing sample ranges from the audio played before
+// them, and cross-fades back into real audio when it resumes.
+//
+// Waveform follows ITU-T G.711 Appendix I: the pitch period is found by
+// normalized cross-correlation, the last period is repeated, and after 10 ms
+// and 20 ms of loss two and then three periods are cycled, joined by
+// overlap-add. Output fades out from 10 ms and is silent after 60 ms. Lpc
+// repeats the pitch period of the linear prediction residual instead and
+// runs it through the LPC synthesis filter, which continues the spectral
+// envelope smoothly from the last real sample. RepeatLast (repeat the last
+// 20 ms, halving each time) and Silence are kept as simple baselines.
+//
+// Not thread-safe; owned by the jitter buffer. Allocates only at construction.
+class PacketLossConcealer {
+public:
+    enum class Mode {
+        Silence,
+        RepeatLast,
+        Waveform,
+        Lpc
+    };
+
+    PacketLossConcealer(int sampleRate, Mode mode);
+
+    // Audio that is about to be played. The start of the first chunk after a
+    // gap is cross-faded in place from the concealment's continuation.
+    void play(int16_t* samples, size_t count);
+    // Fill `out` with the next `count` samples of concealment
+    void conceal(int16_t* out, size_t count);
+    // The next audio played does not follow on from the last (the jitter
+    // buffer skipped ahead), so cross-fade into it from a pitch-synchronous
+    // continuation of what was played, whatever the mode
+    void splice();
+
+    bool isConcealing() const { return concealing_; }
+    Mode mode() const { return mode_; }
+    void reset();
+
+private:
+    void appendHistory(const float* samples, size_t count);
+    const float* historyEnd() const { return history_.data() + historyEnd_; }
+
+    void startGap(Mode mode);
+    size_t findPitchPeriod() const;
+    bool computeLpc();
+    float nextSample();
+    float readPeriods(size_t periods, size_t& pos) const;
+    void generate(float* out, size_t count);
+
+    static float dot(const float* a, const float* b, size_t n);
+
+    int sampleRate_;
+    Mode mode_;
+
+    size_t minPitch_;
+    size_t maxPitch_;
+    size_t correlationLength_;
+    size_t historySize_;
+
+    // Last historySize_ played samples, contiguous at [historyEnd_ - historySize_, historyEnd_)
+    std::vector<float> history_;
+    size_t historyEnd_;
+    size_t historyFill_ = 0;
+
+    // Concealment state for the current gap
+    bool concealing_ = false;
+    bool splicing_ = false;               // Gap started by splice(), nothing concealed yet
+    Mode gapMode_;                        // mode_, or Waveform/Lpc for a splice
+    bool silent_ = false;                 // Not enough history; concealment is silence
+    size_t pitch_ = 0;
+    std::vector<float> pitchBuffer_;      // Last 3 periods of signal (Waveform) or residual (Lpc)
+    size_t periods_ = 1;                  // Periods being cycled
+    size_t pos_ = 0;                      // Read offset within the cycled periods
+    size_t fadePos_ = 0;                  // Read offset in the previous period count during overlap-add
+    size_t fadeRemaining_ = 0;
+    size_t overlap_ = 0;                  // Overlap-add length, 1/4 period
+    size_t concealed_ = 0;                // Samples synthesized in this gap
+    float repeatGain_ = 1.0f;             // RepeatLast only
+
+    // LPC synthesis filter, A(z) = 1 + sum a[k] z^-k, and its past outputs (newest first)
+    std::vector<float> lpc_;
+    std::vector<float> lpcMemory_;
+    std::vector<float> lpcWindow_;
+
+    std::vector<float> scratch_;
+
+    static constexpr int MIN_PITCH_MS = 5;         // 200 Hz
+    static constexpr int MAX_PITCH_MS = 15;        // 66 Hz
+    static constexpr int CORRELATION_MS = 20;
+    static constexpr int REPEAT_MS = 20;           // RepeatLast period
+    static constexpr int ATTENUATION_START_MS = 10;
+    static constexpr int ATTENUATION_END_MS = 60;
+    static constexpr int MAX_MERGE_MS = 10;
+    static constexpr size_t LPC_ORDER = 16;
+    static constexpr size_t SCRATCH_SIZE = 1024;
+};
@@ -1,25 +1,63 @@
 #pragma once
 
+#include "PacketBufferPool.h"
+#include "Histogram.h"
 #include <vector>
 #include <cstdint>
 #include <optional>
+#include <chrono>
+#include <cstring>
 
 struct AudioPacket {
     uint16_t sequenceNumber;
     uint32_t sampleTimestamp;
-    std::vector<int16_t> audioSamples;
+    PacketBuffer audioSamples;  // Pooled when the parser has a pool
+    int64_t arrivalTimeNs = 0;  // Receive time on the steady clock (kernel timestamp when available)
     
-    AudioPacket(uint16_t seq, uint32_t timestamp, std::vector<int16_t> samples)
+    AudioPacket(uint16_t seq, uint32_t timestamp, PacketBuffer samples)
         : sequenceNumber(seq), sampleTimestamp(timestamp), audioSamples(std::move(samples)) {}
 };
 
+// Non-owning parse result: header fields plus the payload where it lies in
+// the receive buffer. Valid only as long as that buffer is; the payload may
+// be unaligned, so samples are read with copySamples().
+struct AudioPacketView {
+    uint16_t sequenceNumber = 0;
+    uint32_t sampleTimestamp = 0;
+    const uint8_t* payload = nullptr;  // Little-endian 16-bit samples
+    size_t sampleCount = 0;
+    int64_t arrivalTimeNs = 0;         // Receive time on the steady clock
+
+    // Copy `count` samples starting at sample `offset` into `dst`
+    void copySamples(int16_t* dst, size_t offset, size_t count) const {
+        std::memcpy(dst, payload + offset * sizeof(int16_t), count * sizeof(int16_t));
+    }
+};
+
 class PacketParser {
 public:
-    PacketParser();
+    using Clock = std::chrono::steady_clock;
+
+    explicit PacketParser(int sampleRate = 16000);
     ~PacketParser() = default;
 
+    // Owning packets take their buffers from `pool` (which must outlive the
+    // parser) instead of the heap
+    void setBufferPool(PacketBufferPool* pool) { pool_ = pool; }
+    // Record each packet's transit time deviation |D|, in ns, into
+    // `histogram`; it must outlive the parser and have no other writer
+    void setJitterHistogram(Histogram* histogram) { jitterHistogram_ = histogram; }
+
     // Parse UDP packet data into AudioPacket
     std::optional<AudioPacket> parsePacket(const uint8_t* data, size_t length);
+    std::optional<AudioPacket> parsePacket(const uint8_t* data, size_t length, Clock::time_point arrival);
+
+    // Parse without copying or allocating; the view points into `data`
+    std::optional<AudioPacketView> parseView(const uint8_t* data, size_t length, Clock::time_point arrival);
+
+    // Whether `data` is a frame parseView accepts, without touching any
+    // parser's state; logs odd payload lengths
+    static bool isWellFormed(const uint8_t* data, size_t length);
     
     // Packet tracking and statistics
     struct PacketStats {
@@ -28,14 +66,24 @@ public:
         uint64_t outOfOrder = 0;
         uint16_t lastSequenceNumber = 0;
         bool firstPacketReceived = false;
+        double jitter = 0.0;  // RFC 3550 interarrival jitter estimate, in samples
     };
 
     const PacketStats& getStats() const { return stats_; }
+    double getJitterMs() const { return stats_.jitter * 1000.0 / sampleRate_; }
     void resetStats();
 
 private:
+    int sampleRate_;
     PacketStats stats_;
-    
+    PacketBufferPool* pool_ = nullptr;
+    Histogram* jitterHistogram_ = nullptr;
+
+    // Previous packet's arrival and timestamp for the jitter estimate
+    Clock::time_point lastArrival_;
+    uint32_t lastTimestamp_ = 0;
+
     void updateStatistics(uint16_t sequenceNumber);
+    void updateJitter(uint32_t sampleTimestamp, Clock::time_point arrival);
     bool isSequenceNumberValid(uint16_t current, uint16_t expected) const;
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Chooses the jitter buffer playout delay from the measured interarrival
+// jitter. The delay grows immediately when jitter or late packets demand it
+// and shrinks slowly once the network calms down, so a clean LAN settles at
+// a few milliseconds while a noisy Wi-Fi link keeps enough headroom.
+class PlayoutDelayController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        double minDelayMs = 10.0;
+        double maxDelayMs = 500.0;
+        double jitterMultiplier = 4.0;   // Target = multiplier * jitter + margin
+        double marginMs = 5.0;
+        double lateBumpMs = 10.0;        // Extra headroom added per update with late packets
+        double shrinkRateMsPerSec = 10.0;
+        double updateIntervalMs = 100.0;
+    };
+
+    explicit PlayoutDelayController(double initialDelayMs);
+    PlayoutDelayController(double initialDelayMs, const Config& config);
+
+    // Feed the current jitter estimate and the running late-packet count;
+    // returns true when the target delay changed
+    bool update(double jitterMs, uint64_t latePackets, Clock::time_point now);
+
+    double getTargetDelayMs() const { return targetDelayMs_; }
+
+private:
+    Config config_;
+    double targetDelayMs_;
+    double lateHeadroomMs_ = 0.0;
+    uint64_t lastLatePackets_ = 0;
+    bool started_ = false;
+    Clock::time_point lastUpdate_;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <vector>
+#include <cstddef>
+
+// Converts a mono float stream between two fixed sample rates with a
+// polyphase FIR: the rate ratio is reduced to up/down factors L/M, and a
+// Kaiser-windowed sinc low-pass, designed at L times the input rate, is split
+// into L phases of equal length. Each output sample is one dot product of a
+// phase against the newest input, so the cost per output does not depend on
+// L. The response is flat to 90% of the lower rate's Nyquist frequency and
+// down 80 dB from Nyquist on; the filter is as long as that transition needs.
+//
+// The dot product runs on AVX2/FMA, SSE2 or NEON when the CPU has them,
+// chosen once at runtime, with a scalar fallback. Not thread-safe; allocates
+// only at construction.
+class PolyphaseResampler {
+public:
+    using Kernel = SimdKernel;
+
+    // `maxInput` bounds the samples passed to each process() call
+    PolyphaseResampler(int inputRate, int outputRate, size_t maxInput, Kernel kernel = Kernel::Auto);
+
+    // Convert `count` (<= maxInput) samples; returns the number written to
+    // `out`, which must have room for maxOutput()
+    size_t process(const float* in, size_t count, float* out);
+    size_t maxOutput() const { return maxOutput_; }
+    void reset();
+
+    int upFactor() const { return up_; }
+    int downFactor() const { return down_; }
+    size_t tapsPerPhase() const { return taps_; }
+    // Delay through the filter, in input samples
+    double latencySamples() const;
+    Kernel kernel() const { return kernel_; }
+
+    // False when the reduced ratio would need an unreasonably large filter
+    // bank (e.g. 16001 Hz to 48000 Hz)
+    static bool isSupported(int inputRate, int outputRate);
+
+private:
+    using DotFunction = float (*)(const float* a, const float* b, size_t n);
+
+    void designFilter();
+
+    int up_;
+    int down_;
+    size_t taps_;                 // Per phase, a multiple of 8
+    size_t maxInput_;
+    size_t maxOutput_;
+    Kernel kernel_;
+    DotFunction dot_;
+
+    // Row p holds phase p's taps, newest-input tap last, so a dot product
+    // with the input window starting at the oldest sample gives the output
+    std::vector<float> coefficients_;
+    // Last taps_ - 1 inputs followed by the current block
+    std::vector<float> window_;
+
+    size_t phase_ = 0;            // Phase of the next output, 0..up_-1
+    size_t position_ = 0;         // Input index of the next output's newest sample
+
+    static constexpr size_t MAX_TAPS = 512;      // Per phase
+    static constexpr size_t MAX_COEFFICIENTS = 1 << 20;
+    static constexpr double PASSBAND = 0.9;      // Of the lower Nyquist frequency
+    static constexpr double STOPBAND_DB = 80.0;
+};
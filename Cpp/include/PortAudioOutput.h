@@ -0,0 +1,46 @@
+#pragma once
+
+#include "AudioOutput.h"
+#include <portaudio.h>
+#include <vector>
+
+// The default output device, driven by PortAudio's real-time callback. The
+// stream is float32 unless int16 is requested or the device rejects float,
+// in which case rendered buffers are converted (and dithered) in the callback.
+class PortAudioOutput : public AudioOutput {
+public:
+    PortAudioOutput(AudioOutputConfig::SampleFormat format = AudioOutputConfig::SampleFormat::Auto,
+                    bool dither = false);
+    ~PortAudioOutput() override;
+
+    bool open(int sampleRate, size_t framesPerBuffer, RenderCallback callback, void* userData) override;
+    bool start() override;
+    void stop() override;
+    void close() override;
+
+    const char* name() const override { return "PortAudio"; }
+    const char* sampleFormat() const override { return float_ ? "float32" : "int16"; }
+    // The default output device's default rate, usually 44100 or 48000
+    int nativeSampleRate() const override;
+
+    // True when PortAudio reports a default output device
+    static bool deviceAvailable();
+
+private:
+    static int streamCallback(const void* inputBuffer, void* outputBuffer,
+                              unsigned long framesPerBuffer,
+                              const PaStreamCallbackTimeInfo* timeInfo,
+                              PaStreamCallbackFlags statusFlags,
+                              void* userData);
+
+    AudioOutputConfig::SampleFormat requestedFormat_;
+    bool dither_;
+    bool float_ = true;
+    std::vector<float> scratch_;     // Rendered audio awaiting int16 conversion
+    uint32_t ditherSeed_ = 0x9E3779B9;
+
+    PaStream* stream_ = nullptr;
+    bool paInitialized_ = false;
+    RenderCallback callback_ = nullptr;
+    void* userData_ = nullptr;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+// Fixed-capacity single-producer/single-consumer ring buffer.
+//
+// One thread may call write()/writeSpans()/commitWrite(), one other thread may
+// call read()/readSpans()/commitRead()/discard(). Neither side ever blocks or
+// allocates after construction, so the consumer is safe to use from the
+// PortAudio callback. Indices are free-running and masked into a power-of-two
+// storage block; the read and write indices live on separate cache lines so
+// the two threads do not false-share.
+template <typename T>
+class SPSCRingBuffer {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SPSCRingBuffer elements are moved with memcpy");
+
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // A contiguous region of the ring; a logical range may wrap and therefore
+    // be split into two spans.
+    template <typename U>
+    struct Span {
+        U* data = nullptr;
+        size_t size = 0;
+    };
+
+    explicit SPSCRingBuffer(size_t capacity)
+        : capacity_(capacity), mask_(roundUpPow2(capacity) - 1),
+          storage_(new T[mask_ + 1]) {}
+
+    SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+    SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    // Approximate when called from a thread that is neither producer nor consumer
+    size_t size() const {
+        size_t w = writeIndex_.load(std::memory_order_acquire);
+        size_t r = readIndex_.load(std::memory_order_acquire);
+        return w - r;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Producer side ---------------------------------------------------------
+
+    size_t writeAvailable() const {
+        size_t w = writeIndex_.load(std::memory_order_relaxed);
+        size_t r = readIndex_.load(std::memory_order_acquire);
+        return capacity_ - (w - r);
+    }
+
+    // Expose up to `count` free slots as one or two spans without publishing them
+    size_t writeSpans(size_t count, Span<T>& first, Span<T>& second) {
+        size_t w = writeIndex_.load(std::memory_order_relaxed);
+        size_t r = readIndex_.load(std::memory_order_acquire);
+        size_t n = std::min(count, capacity_ - (w - r));
+        splitSpans(w, n, first, second);
+        return n;
+    }
+
+    void commitWrite(size_t count) {
+        writeIndex_.store(writeIndex_.load(std::memory_order_relaxed) + count,
+                          std::memory_order_release);
+    }
+
+    // Copy as many items as fit; returns the number actually written
+    size_t write(const T* src, size_t count) {
+        Span<T> first, second;
+        size_t n = writeSpans(count, first, second);
+        std::memcpy(first.data, src, first.size * sizeof(T));
+        if (second.size > 0) {
+            std::memcpy(second.data, src + first.size, second.size * sizeof(T));
+        }
+        commitWrite(n);
+        return n;
+    }
+
+    // Consumer side ---------------------------------------------------------
+
+    size_t readAvailable() const {
+        size_t r = readIndex_.load(std::memory_order_relaxed);
+        size_t w = writeIndex_.load(std::memory_order_acquire);
+        return w - r;
+    }
+
+    // Expose up to `count` queued items as one or two spans without consuming them
+    size_t readSpans(size_t count, Span<const T>& first, Span<const T>& second) const {
+        size_t r = readIndex_.load(std::memory_order_relaxed);
+        size_t w = writeIndex_.load(std::memory_order_acquire);
+        size_t n = std::min(count, w - r);
+        Span<T> a, b;
+        splitSpans(r, n, a, b);
+        first = {a.data, a.size};
+        second = {b.data, b.size};
+        return n;
+    }
+
+    void commitRead(size_t count) {
+        readIndex_.store(readIndex_.load(std::memory_order_relaxed) + count,
+                         std::memory_order_release);
+    }
+
+    // Copy out up to `count` items; returns the number actually read
+    size_t read(T* dst, size_t count) {
+        Span<const T> first, second;
+        size_t n = readSpans(count, first, second);
+        std::memcpy(dst, first.data, first.size * sizeof(T));
+        if (second.size > 0) {
+            std::memcpy(dst + first.size, second.data, second.size * sizeof(T));
+        }
+        commitRead(n);
+        return n;
+    }
+
+    // Drop up to `count` of the oldest items; returns the number dropped
+    size_t discard(size_t count) {
+        size_t n = std::min(count, readAvailable());
+        commitRead(n);
+        return n;
+    }
+
+private:
+    static size_t roundUpPow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    void splitSpans(size_t index, size_t count, Span<T>& first, Span<T>& second) const {
+        size_t start = index & mask_;
+        size_t firstCount = std::min(count, (mask_ + 1) - start);
+        first = {storage_.get() + start, firstCount};
+        second = {storage_.get(), count - firstCount};
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> storage_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> writeIndex_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> readIndex_{0};
+};
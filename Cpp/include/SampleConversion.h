@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Conversion between the int16 samples on the wire and in files and the
+// float samples the playback path works in, where full scale is +-1.0
+// (int16 / 32768) and gain, mixing and filtering can exceed it without
+// wrapping. Float to int16 saturates and rounds to nearest. The dithered
+// variant adds triangular (TPDF) noise of +-1 LSB first, so requantizing a
+// processed signal leaves a constant noise floor instead of distortion
+// correlated with the signal.
+//
+// SSE2, AVX2 and NEON kernels are chosen once at runtime, with a scalar
+// fallback. All functions are safe for the audio callback.
+
+constexpr float INT16_TO_FLOAT = 1.0f / 32768.0f;
+
+void int16ToFloat(const int16_t* in, float* out, size_t count);
+void floatToInt16(const float* in, int16_t* out, size_t count);
+// `seed` is the caller's noise generator state, any nonzero value
+void floatToInt16Dithered(const float* in, int16_t* out, size_t count, uint32_t& seed);
+
+// Multiply in place
+void applyGain(float* samples, size_t count, float gain);
+
+// Name of the kernel in use: "avx2", "sse2", "neon" or "scalar"
+const char* sampleConversionKernel();
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Test signal settings for the sender
+struct SignalConfig {
+    enum class Type {
+        Tone,           // One sine at `frequency`
+        WhiteNoise,
+        PinkNoise,      // -3 dB per octave
+        Chirp,          // Linear sweep from `frequency` to `endFrequency`, repeated
+        MultiTone       // Equal-amplitude sines at `frequencies`
+    };
+
+    // How sines are computed
+    enum class Oscillator {
+        Wavetable,      // 32-bit phase accumulator into a 4096-point table, interpolated
+        Recursive,      // Rotation by a fixed angle per sample, renormalized per block
+        Direct          // std::sin per sample; the reference
+    };
+
+    Type type = Type::Tone;
+    Oscillator oscillator = Oscillator::Wavetable;
+    int sampleRate = 16000;
+    double amplitude = 0.3;             // Peak, of full scale
+    double frequency = 440.0;           // Hz; the chirp's start
+    double endFrequency = 4000.0;       // Chirp
+    double sweepSeconds = 1.0;          // Chirp
+    std::vector<double> frequencies;    // Multi-tone; empty uses DEFAULT_FREQUENCIES
+    uint64_t seed = 1;                  // Noise
+
+    static constexpr double DEFAULT_FREQUENCIES[] = {300.0, 1000.0, 3000.0};
+};
+
+// Continuous int16 signal delivered in whatever block sizes are asked for.
+// Writes straight into the caller's buffer and never allocates after
+// construction, so one thread can feed many streams.
+class SignalGenerator {
+public:
+    virtual ~SignalGenerator() = default;
+
+    virtual void generate(int16_t* out, size_t count) = 0;
+    // e.g. "tone 440 Hz (table)"
+    virtual std::string describe() const = 0;
+};
+
+// Chirps always use the wavetable, whose frequency can change every sample
+std::unique_ptr<SignalGenerator> createSignalGenerator(const SignalConfig& config);
+
+const char* signalTypeName(SignalConfig::Type type);
+const char* oscillatorName(SignalConfig::Oscillator oscillator);
@@ -3,12 +3,21 @@
 #include <string>
 #include <memory>
 #include <atomic>
-#include <thread>
-#include <mutex>
+#include <vector>
+#include <optional>
+#include <unordered_map>
 #include <cstdint>
+#include "JitterBuffer.h"
+#include "AudioMixer.h"
+#include "AudioOutput.h"
+#include "DatagramReceiver.h"
+#include "AudioStream.h"
+#include "PacketBufferPool.h"
+#include "Histogram.h"
+#include "Logger.h"
 
 class AudioPlayer;
-class PacketParser;
+class MetricsServer;
 
 class UDPAudioStreamer {
 public:
@@ -19,39 +28,153 @@ public:
     void stop();
     bool isRunning() const { return running_.load(); }
 
+    // Must be called before start()
+    void setJitterBufferConfig(const JitterBuffer::Config& config);
+    void setAdaptivePlayoutDelay(bool enabled) { adaptiveDelay_ = enabled; }
+    void setAudioOutput(const AudioOutputConfig& config);
+    // Track the sender's clock: jitter buffers release at its measured rate
+    // and playback is resampled to it against the device's. Off, everything
+    // runs at the nominal sample rate.
+    void setDriftCompensation(bool enabled);
+    // Playback gain in dB, applied in the float path before the output
+    void setGainDb(double db);
+    // Play every sender summed on a common timeline instead of only the first
+    void setMixing(bool enabled, AudioMixer::Summation summation = AudioMixer::Summation::Saturate);
+    // Gain in dB for the sender at "address:port" when mixing
+    void setStreamGain(const std::string& source, double db);
+    // Datagrams pulled per receive syscall (recvmmsg, Linux only)
+    void setReceiveBatchSize(size_t batchSize) { receiveBatchSize_ = batchSize; }
+    // Receive threads, each with its own SO_REUSEPORT socket (Linux only)
+    void setReceiveWorkers(size_t workers) { workerCount_ = workers; }
+    // Steer each sender to a fixed worker with a reuseport BPF program
+    void setSteerBySource(bool enabled) { steerBySource_ = enabled; }
+    // Serve Prometheus metrics on 127.0.0.1:<port>/metrics; 0 disables
+    void setMetricsPort(int port) { metricsPort_ = port; }
+
     // Statistics
     struct Statistics {
         uint64_t packetsReceived = 0;
         uint64_t packetsDropped = 0;
         uint64_t packetsOutOfOrder = 0;
         uint64_t bytesReceived = 0;
-        double dropRate = 0.0;
+        double dropRate = 0.0;         // packetsDropped / (packetsReceived + packetsDropped)
+        uint64_t packetsLate = 0;      // Arrived after their playout time
+        uint64_t packetsDuplicate = 0;
+        uint64_t samplesConcealed = 0;
+        uint64_t packetsRejected = 0;  // Stream table full
+        uint64_t activeStreams = 0;
+        double jitterMs = 0.0;         // RFC 3550 interarrival jitter estimate (primary stream)
+        double targetDelayMs = 0.0;    // Current playout delay (primary stream)
+        uint64_t bufferUnderruns = 0;  // Playback ran out of queued audio
+        uint64_t samplesOverflowed = 0; // Dropped because the playback queue was full
+        uint64_t queuedSamples = 0;    // Playback queue depth
+        double clockDriftPpm = 0.0;    // Sender clock against the output device
+        uint64_t samplesMixedLate = 0; // Reached the mixer after their instant was played
+        uint64_t mixRealigns = 0;      // Streams re-placed on the mix timeline
+    };
+
+    // Snapshot of the totals across all senders, including ones already
+    // evicted as idle, merged with the player's counters. Lock-free with
+    // respect to the packet path; safe to call from any thread at any rate.
+    Statistics getStatistics() const;
+    std::vector<StreamStatistics> getStreamStatistics() const;
+
+    // Distributions recorded on the packet and audio paths since start()
+    struct Histograms {
+        Histogram::Snapshot jitter;            // Per-packet transit deviation |D|, ns (all streams)
+        Histogram::Snapshot playoutLatency;    // Receive to jitter buffer release, ns (all streams)
+        Histogram::Snapshot callbackDuration;  // Audio callback run time, ns
+        Histogram::Snapshot queueDepth;        // Playback queue at each callback, samples
     };
 
-    Statistics getStatistics() const { return stats_; }
+    // Lock-free with respect to the packet path and the audio callback
+    Histograms getHistograms() const;
+    // Percentile summary as indented text lines or one JSON object
+    std::string formatHistograms(const Histograms& histograms, bool json) const;
+    // Counters, per-stream gauges and histogram summaries in the Prometheus
+    // text exposition format
+    std::string formatMetrics() const;
 
 private:
-    void udpReceiverThread();
-    bool initializeSocket();
+    struct ReceiveWorker;
+
+    struct StreamSnapshot {
+        uint64_t key;
+        StreamCounters counters;
+    };
+
+    void udpReceiverThread(ReceiveWorker& worker);
+    int receiveDatagrams(ReceiveWorker& worker);
+    void handleDatagram(ReceiveWorker& worker, const DatagramReceiver::Datagram& datagram);
+    AudioStream* findOrCreateStream(ReceiveWorker& worker, const sockaddr_in& source,
+                                    JitterBuffer::Clock::time_point now);
+    std::optional<JitterBuffer::Clock::time_point> servicePlayout(ReceiveWorker& worker,
+                                                                  JitterBuffer::Clock::time_point now);
+    void evictIdleStreams(ReceiveWorker& worker, JitterBuffer::Clock::time_point now);
+    // After the primary stream was evicted, hand its role to a live stream
+    void promotePrimaryStream(ReceiveWorker& worker);
+    // Stream lifecycle messages go through the async logger, so the receive
+    // thread never writes to the console while holding a table lock
+    static void logStream(Logger::Event event, uint64_t key);
+    // Counters of every live stream, plus those of evicted ones summed into
+    // `retired`. Each table lock is held only for a flat copy, so a metrics
+    // scrape never makes a receive thread wait while it aggregates or formats.
+    std::vector<StreamSnapshot> snapshotStreams(StreamCounters& retired) const;
+    bool initializeSocket(ReceiveWorker& worker);
+    bool initializeEventLoop(ReceiveWorker& worker);
+#ifdef __linux__
+    void armReleaseTimer(ReceiveWorker& worker, std::optional<JitterBuffer::Clock::time_point> deadline);
+    bool attachSteeringProgram();
+    static void pinToCore(size_t index);
+#endif
     void cleanup();
+    static void deliverMix(const float* samples, size_t count, void* userData);
+
+    static constexpr int RECEIVE_TIMEOUT_MS = 5;     // Polling interval without epoll
+    static constexpr int MAX_RECEIVES_PER_WAKE = 64;
+    static constexpr size_t MAX_DATAGRAM_SIZE = 4096;
+    static constexpr size_t MAX_STREAMS = 4096;      // Shared evenly between workers
+    static constexpr int STREAM_IDLE_TIMEOUT_S = 10;
+    static constexpr uint64_t NO_STREAM = ~0ULL;
+    static constexpr size_t PACKET_POOL_BUFFERS = 1024;  // Pool slab, ~4 MB of MAX_DATAGRAM_SIZE buffers
+    static constexpr double NOMINAL_PACKET_MS = 20.0;    // Packet length assumed when sizing the pool
 
     int port_;
     int sampleRate_;
     std::string saveFile_;
 
     std::atomic<bool> running_{false};
-    std::thread udpThread_;
 
     std::unique_ptr<AudioPlayer> audioPlayer_;
-    std::unique_ptr<PacketParser> packetParser_;
+    JitterBuffer::Config jitterConfig_;
+    bool adaptiveDelay_ = false;
+    bool driftCompensation_ = true;
+    size_t receiveBatchSize_ = 1;
+    size_t workerCount_ = 1;
+    bool steerBySource_ = false;
+    int metricsPort_ = 0;
+    std::unique_ptr<MetricsServer> metricsServer_;
+    bool mixing_ = false;
+    AudioMixer::Summation summation_ = AudioMixer::Summation::Saturate;
+    std::unordered_map<std::string, float> streamGains_;
+    // Shared by all workers when mixing; serializes their writes to the player
+    std::unique_ptr<AudioMixer> mixer_;
 
-    // Socket handle (platform-specific)
-#ifdef _WIN32
-    uintptr_t socket_ = 0;  // SOCKET on Windows
-#else
-    int socket_ = -1;       // file descriptor on Unix
-#endif
+    // Buffers for packets held in jitter buffers, shared by all workers.
+    // Declared before workers_ so it outlives every stream.
+    std::unique_ptr<PacketBufferPool> packetPool_;
+    // Pool buffers set aside per admitted stream: its playout delay plus
+    // reorder window in nominal packets. The pool grows by slabs as streams
+    // are admitted, so steady-state receive never falls back to the heap.
+    size_t packetsPerStream_ = 0;
+    std::atomic<size_t> streamCount_{0};
+
+    // Each worker owns a socket, thread and the streams of the senders the
+    // kernel routes to it
+    std::vector<std::unique_ptr<ReceiveWorker>> workers_;
 
-    Statistics stats_;
-    mutable std::mutex statsMutex_;
-};
\ No newline at end of file
+    // Without mixing only the primary stream (the first sender heard, on any
+    // worker, or a live one promoted when it goes idle) is played; its key,
+    // or NO_STREAM. Its jitter and delay are the ones reported either way.
+    std::atomic<uint64_t> primaryStream_{NO_STREAM};
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SPSCRingBuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records mono 16-bit audio to a WAV file from a dedicated writer thread.
+//
+// The producer copies samples into fixed-size blocks taken from a preallocated
+// pool and hands full blocks to the writer through a lock-free queue; the
+// writer returns them through a second queue once they are on disk. Memory is
+// therefore bounded by the pool, and if the disk falls behind far enough to
+// exhaust it, new audio is dropped and counted rather than buffered. The RIFF
+// header is rewritten about once a second, so a crash leaves a playable file
+// holding everything up to the last update.
+//
+// write() and flush() must be called from one producer thread at a time.
+class WavFileWriter {
+public:
+    explicit WavFileWriter(int sampleRate, size_t blockSamples = 4096, size_t blockCount = 64);
+    ~WavFileWriter();
+
+    bool open(const std::string& path);
+
+    // Copy samples into the current block; returns false if any were dropped
+    bool write(const int16_t* samples, size_t count);
+
+    // Hand the partially filled block to the writer thread
+    void flush();
+
+    // Write everything queued, finalize the header and close the file
+    void close();
+
+    bool isOpen() const { return writerThread_.joinable(); }
+    uint64_t getSamplesWritten() const { return samplesWritten_.load(std::memory_order_relaxed); }
+    uint64_t getSamplesDropped() const { return samplesDropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Block {
+        std::unique_ptr<int16_t[]> samples;
+        size_t count = 0;
+    };
+
+    static constexpr uint32_t NO_BLOCK = ~0u;
+    static constexpr int WRITE_INTERVAL_MS = 20;
+    static constexpr int HEADER_UPDATE_INTERVAL_MS = 1000;
+
+    void writerThread();
+    size_t writeQueuedBlocks();
+    void writeHeader();
+    void updateHeader();
+
+    int sampleRate_;
+    size_t blockSamples_;
+    std::vector<Block> blocks_;
+
+    // Block indices: producer -> writer, and back once written
+    SPSCRingBuffer<uint32_t> filledBlocks_;
+    SPSCRingBuffer<uint32_t> freeBlocks_;
+    uint32_t currentBlock_ = NO_BLOCK;   // Being filled by the producer
+
+    std::ofstream file_;
+    std::thread writerThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> samplesWritten_{0};
+    std::atomic<uint64_t> samplesDropped_{0};
+};
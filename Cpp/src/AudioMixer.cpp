@@ -0,0 +1,324 @@
+#include "AudioMixer.h"
+#include "SampleConversion.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+constexpr float KNEE = AudioMixer::KNEE;
+constexpr float KNEE_RANGE = 1.0f - KNEE;
+
+// Knee followed by a tanh curve, using the Pade approximant
+// tanh(u) ~ u (27 + u^2) / (27 + 9 u^2), which reaches exactly 1 at u = 3.
+// Slope is 1 on both sides of the knee, so there is no audible corner.
+inline float softClip(float x) {
+    float a = std::fabs(x);
+    if (a <= KNEE) return x;
+    float u = std::min((a - KNEE) / KNEE_RANGE, 3.0f);
+    float t = u * (27.0f + u * u) / (27.0f + 9.0f * u * u);
+    return std::copysign(KNEE + KNEE_RANGE * t, x);
+}
+
+void accumulateScalar(const int16_t* in, float* mix, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        mix[i] += in[i] * gain;
+    }
+}
+
+void saturateScalar(float* mix, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = std::clamp(mix[i], -1.0f, 1.0f);
+        mix[i] = 0.0f;
+    }
+}
+
+void softClipScalar(float* mix, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = softClip(mix[i]);
+        mix[i] = 0.0f;
+    }
+}
+
+#ifdef AUDIO_SIMD_SSE2
+void accumulateSse2(const int16_t* in, float* mix, size_t count, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        _mm_storeu_ps(mix + i, _mm_add_ps(_mm_loadu_ps(mix + i), _mm_mul_ps(lo, g)));
+        _mm_storeu_ps(mix + i + 4, _mm_add_ps(_mm_loadu_ps(mix + i + 4), _mm_mul_ps(hi, g)));
+    }
+    accumulateScalar(in + i, mix + i, count - i, gain);
+}
+
+void saturateSse2(float* mix, float* out, size_t count) {
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(mix + i), lo), hi));
+        _mm_storeu_ps(mix + i, zero);
+    }
+    saturateScalar(mix + i, out + i, count - i);
+}
+
+void softClipSse2(float* mix, float* out, size_t count) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 knee = _mm_set1_ps(KNEE);
+    const __m128 range = _mm_set1_ps(KNEE_RANGE);
+    const __m128 inverseRange = _mm_set1_ps(1.0f / KNEE_RANGE);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 c27 = _mm_set1_ps(27.0f);
+    const __m128 c9 = _mm_set1_ps(9.0f);
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(mix + i);
+        __m128 a = _mm_andnot_ps(sign, x);
+        __m128 u = _mm_min_ps(_mm_mul_ps(_mm_max_ps(_mm_sub_ps(a, knee), zero), inverseRange), three);
+        __m128 u2 = _mm_mul_ps(u, u);
+        __m128 t = _mm_div_ps(_mm_mul_ps(u, _mm_add_ps(c27, u2)), _mm_add_ps(c27, _mm_mul_ps(c9, u2)));
+        __m128 y = _mm_add_ps(_mm_min_ps(a, knee), _mm_mul_ps(range, t));
+        _mm_storeu_ps(out + i, _mm_or_ps(y, _mm_and_ps(sign, x)));
+        _mm_storeu_ps(mix + i, zero);
+    }
+    softClipScalar(mix + i, out + i, count - i);
+}
+#endif
+
+#ifdef AUDIO_SIMD_X86
+AUDIO_TARGET_AVX2
+void accumulateAvx2(const int16_t* in, float* mix, size_t count, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8))));
+        _mm256_storeu_ps(mix + i, _mm256_fmadd_ps(lo, g, _mm256_loadu_ps(mix + i)));
+        _mm256_storeu_ps(mix + i + 8, _mm256_fmadd_ps(hi, g, _mm256_loadu_ps(mix + i + 8)));
+    }
+    accumulateScalar(in + i, mix + i, count - i, gain);
+}
+
+AUDIO_TARGET_AVX2
+void saturateAvx2(float* mix, float* out, size_t count) {
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(mix + i), lo), hi));
+        _mm256_storeu_ps(mix + i, zero);
+    }
+    saturateScalar(mix + i, out + i, count - i);
+}
+
+AUDIO_TARGET_AVX2
+void softClipAvx2(float* mix, float* out, size_t count) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 knee = _mm256_set1_ps(KNEE);
+    const __m256 range = _mm256_set1_ps(KNEE_RANGE);
+    const __m256 inverseRange = _mm256_set1_ps(1.0f / KNEE_RANGE);
+    const __m256 three = _mm256_set1_ps(3.0f);
+    const __m256 c27 = _mm256_set1_ps(27.0f);
+    const __m256 c9 = _mm256_set1_ps(9.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(mix + i);
+        __m256 a = _mm256_andnot_ps(sign, x);
+        __m256 u = _mm256_min_ps(_mm256_mul_ps(_mm256_max_ps(_mm256_sub_ps(a, knee), zero), inverseRange), three);
+        __m256 u2 = _mm256_mul_ps(u, u);
+        __m256 t = _mm256_div_ps(_mm256_mul_ps(u, _mm256_add_ps(c27, u2)), _mm256_fmadd_ps(c9, u2, c27));
+        __m256 y = _mm256_fmadd_ps(range, t, _mm256_min_ps(a, knee));
+        _mm256_storeu_ps(out + i, _mm256_or_ps(y, _mm256_and_ps(sign, x)));
+        _mm256_storeu_ps(mix + i, zero);
+    }
+    softClipScalar(mix + i, out + i, count - i);
+}
+#endif
+
+#ifdef AUDIO_SIMD_NEON
+void accumulateNeon(const int16_t* in, float* mix, size_t count, float gain) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+        vst1q_f32(mix + i, vmlaq_n_f32(vld1q_f32(mix + i), lo, gain));
+        vst1q_f32(mix + i + 4, vmlaq_n_f32(vld1q_f32(mix + i + 4), hi, gain));
+    }
+    accumulateScalar(in + i, mix + i, count - i, gain);
+}
+
+void saturateNeon(float* mix, float* out, size_t count) {
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vminq_f32(vmaxq_f32(vld1q_f32(mix + i), lo), hi));
+        vst1q_f32(mix + i, zero);
+    }
+    saturateScalar(mix + i, out + i, count - i);
+}
+#endif
+
+#ifdef AUDIO_SIMD_NEON64
+void softClipNeon(float* mix, float* out, size_t count) {
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    const float32x4_t knee = vdupq_n_f32(KNEE);
+    const float32x4_t three = vdupq_n_f32(3.0f);
+    const float32x4_t c27 = vdupq_n_f32(27.0f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vld1q_f32(mix + i);
+        float32x4_t a = vabsq_f32(x);
+        float32x4_t u = vminq_f32(vmulq_n_f32(vmaxq_f32(vsubq_f32(a, knee), zero), 1.0f / KNEE_RANGE), three);
+        float32x4_t u2 = vmulq_f32(u, u);
+        float32x4_t t = vdivq_f32(vmulq_f32(u, vaddq_f32(c27, u2)), vmlaq_n_f32(c27, u2, 9.0f));
+        float32x4_t y = vmlaq_n_f32(vminq_f32(a, knee), t, KNEE_RANGE);
+        vst1q_f32(out + i, vbslq_f32(sign, x, y));
+        vst1q_f32(mix + i, zero);
+    }
+    softClipScalar(mix + i, out + i, count - i);
+}
+#endif
+
+// Ring position of a mix index, which may be negative near the epoch
+inline size_t ringPosition(int64_t index, size_t size) {
+    int64_t position = index % static_cast<int64_t>(size);
+    return static_cast<size_t>(position < 0 ? position + static_cast<int64_t>(size) : position);
+}
+
+}  // namespace
+
+AudioMixer::AudioMixer(int sampleRate, Summation summation, double holdMs, SimdKernel kernel)
+    : sampleRate_(sampleRate), epoch_(Clock::now()) {
+    holdSamples_ = static_cast<int64_t>(holdMs * sampleRate_ / 1000.0);
+    realignSamples_ = static_cast<int64_t>(REALIGN_MS * sampleRate_ / 1000.0);
+    mix_.assign(RING_SECONDS * static_cast<size_t>(sampleRate_), 0.0f);
+    out_.assign(FLUSH_BLOCK, 0.0f);
+
+    kernel_ = resolveSimdKernel(kernel);
+    bool soft = summation == Summation::SoftClip;
+    accumulate_ = accumulateScalar;
+    finalize_ = soft ? softClipScalar : saturateScalar;
+    switch (kernel_) {
+#ifdef AUDIO_SIMD_SSE2
+    case SimdKernel::Sse2:
+        accumulate_ = accumulateSse2;
+        finalize_ = soft ? softClipSse2 : saturateSse2;
+        break;
+#endif
+#ifdef AUDIO_SIMD_X86
+    case SimdKernel::Avx2:
+        accumulate_ = accumulateAvx2;
+        finalize_ = soft ? softClipAvx2 : saturateAvx2;
+        break;
+#endif
+#ifdef AUDIO_SIMD_NEON
+    case SimdKernel::Neon:
+        accumulate_ = accumulateNeon;
+        finalize_ = saturateNeon;
+#ifdef AUDIO_SIMD_NEON64
+        if (soft) finalize_ = softClipNeon;
+#else
+        if (soft) finalize_ = softClipScalar;
+#endif
+        break;
+#endif
+    default:
+        kernel_ = SimdKernel::Scalar;
+        break;
+    }
+}
+
+int64_t AudioMixer::toIndex(Clock::time_point time) const {
+    return std::llround(std::chrono::duration<double>(time - epoch_).count() * sampleRate_);
+}
+
+void AudioMixer::add(Input& input, const int16_t* samples, size_t count, Clock::time_point playoutTime) {
+    if (count == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Stay contiguous unless the stream's timeline moved
+    int64_t index = toIndex(playoutTime);
+    if (!input.aligned || std::llabs(index - input.cursor) > realignSamples_) {
+        if (input.aligned) stats_.realigns++;
+        input.cursor = index;
+        input.aligned = true;
+    }
+    int64_t start = input.cursor;
+    int64_t end = start + static_cast<int64_t>(count);
+    input.cursor = end;
+
+    // Nothing pending: restart emission a hold time ahead of this chunk
+    // instead of playing out the silence since the last one
+    if (readIndex_ >= highWater_) {
+        readIndex_ = std::max(readIndex_, start - holdSamples_);
+    }
+
+    // Whatever was already emitted, or lies beyond the ring, is dropped
+    if (start < readIndex_) {
+        int64_t late = std::min(end, readIndex_) - start;
+        stats_.samplesLate += static_cast<uint64_t>(late);
+        samples += late;
+        start += late;
+    }
+    int64_t limit = readIndex_ + static_cast<int64_t>(mix_.size());
+    if (end > limit) {
+        stats_.samplesLate += static_cast<uint64_t>(end - std::max(start, limit));
+        end = limit;
+    }
+    if (start >= end) return;
+
+    accumulate(input, samples, start, static_cast<size_t>(end - start));
+    highWater_ = std::max(highWater_, end);
+}
+
+void AudioMixer::accumulate(const Input& input, const int16_t* samples, int64_t start, size_t count) {
+    float gain = input.gain * INT16_TO_FLOAT;
+    size_t position = ringPosition(start, mix_.size());
+    size_t first = std::min(count, mix_.size() - position);
+    accumulate_(samples, mix_.data() + position, first, gain);
+    if (first < count) {
+        accumulate_(samples + first, mix_.data(), count - first, gain);
+    }
+}
+
+size_t AudioMixer::flush(Clock::time_point now, Sink sink, void* userData) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int64_t target = std::min(toIndex(now) - holdSamples_, highWater_);
+    size_t emitted = 0;
+    while (readIndex_ < target) {
+        size_t position = ringPosition(readIndex_, mix_.size());
+        size_t count = std::min({static_cast<size_t>(target - readIndex_), FLUSH_BLOCK, mix_.size() - position});
+        // Limits the sums and clears the slots for the next lap of the ring
+        finalize_(mix_.data() + position, out_.data(), count);
+        sink(out_.data(), count, userData);
+        readIndex_ += static_cast<int64_t>(count);
+        emitted += count;
+    }
+    stats_.samplesOut += emitted;
+    return emitted;
+}
+
+bool AudioMixer::nextFlushTime(Clock::time_point& when) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (highWater_ <= readIndex_) return false;
+    double seconds = static_cast<double>(highWater_ + holdSamples_) / sampleRate_;
+    when = epoch_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    return true;
+}
+
+AudioMixer::Stats AudioMixer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
@@ -0,0 +1,21 @@
+#include "AudioOutput.h"
+#include "PortAudioOutput.h"
+#include "HeadlessAudioOutput.h"
+#include <iostream>
+
+std::unique_ptr<AudioOutput> createAudioOutput(const AudioOutputConfig& config) {
+    switch (config.type) {
+    case AudioOutputConfig::Type::Null:
+        return std::make_unique<NullAudioOutput>();
+    case AudioOutputConfig::Type::File:
+        return std::make_unique<FileAudioOutput>(config.path, config.dither);
+    case AudioOutputConfig::Type::Device:
+        break;
+    }
+
+    if (config.fallbackToNull && !PortAudioOutput::deviceAvailable()) {
+        std::cerr << "Warning: No audio output device, playing to the null sink" << std::endl;
+        return std::make_unique<NullAudioOutput>();
+    }
+    return std::make_unique<PortAudioOutput>(config.sampleFormat, config.dither);
+}
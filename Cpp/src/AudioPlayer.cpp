@@ -1,7 +1,10 @@
 #include "AudioPlayer.h"
+#include "Logger.h"
+#include "SampleConversion.h"
 #include <iostream>
-#include <cstring>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 
 AudioPlayer::AudioPlayer(int sampleRate, const std::string& saveFile)
     : sampleRate_(sampleRate), saveFile_(saveFile) {
@@ -12,49 +15,35 @@ AudioPlayer::~AudioPlayer() {
 }
 
 bool AudioPlayer::initialize() {
-    // Initialize PortAudio
-    PaError err = Pa_Initialize();
-    if (err != paNoError) {
-        std::cerr << "PortAudio initialization failed: " << Pa_GetErrorText(err) << std::endl;
-        return false;
-    }
+    output_ = createAudioOutput(outputConfig_);
 
-    // Setup output stream parameters
-    PaStreamParameters outputParameters;
-    outputParameters.device = Pa_GetDefaultOutputDevice();
-    if (outputParameters.device == paNoDevice) {
-        std::cerr << "No default output device found" << std::endl;
-        Pa_Terminate();
-        return false;
+    // Open the sink at its native rate and convert here, rather than leave
+    // it to the host API or fail on devices that only run at 44.1/48 kHz
+    outputRate_ = outputConfig_.sampleRate > 0 ? outputConfig_.sampleRate : output_->nativeSampleRate();
+    if (outputRate_ <= 0) {
+        outputRate_ = sampleRate_;
+    }
+    if (!PolyphaseResampler::isSupported(sampleRate_, outputRate_)) {
+        std::cerr << "Warning: Cannot convert " << sampleRate_ << " Hz to " << outputRate_
+                  << " Hz; opening the output at the stream rate" << std::endl;
+        outputRate_ = sampleRate_;
     }
+    converter_.reset();
+    if (outputRate_ != sampleRate_) {
+        converter_ = std::make_unique<PolyphaseResampler>(sampleRate_, outputRate_, CONVERT_BLOCK);
+        converted_.assign(converter_->maxOutput(), 0.0f);
+    }
+    floatBlock_.assign(CONVERT_BLOCK, 0.0f);
+    pcmBlock_.assign(CONVERT_BLOCK, 0);
 
-    outputParameters.channelCount = 1;  // Mono
-    outputParameters.sampleFormat = paInt16;
-    outputParameters.suggestedLatency = Pa_GetDeviceInfo(outputParameters.device)->defaultLowOutputLatency;
-    outputParameters.hostApiSpecificStreamInfo = nullptr;
-
-    // Open audio stream
-    err = Pa_OpenStream(&stream_,
-                        nullptr,              // no input
-                        &outputParameters,
-                        sampleRate_,
-                        FRAMES_PER_BUFFER,
-                        paClipOff,           // no clipping
-                        audioCallback,
-                        this);               // user data
-
-    if (err != paNoError) {
-        std::cerr << "Failed to open PortAudio stream: " << Pa_GetErrorText(err) << std::endl;
-        Pa_Terminate();
+    if (!output_->open(outputRate_, FRAMES_PER_BUFFER, audioCallback, this)) {
+        output_.reset();
         return false;
     }
 
-    // Start the stream
-    err = Pa_StartStream(stream_);
-    if (err != paNoError) {
-        std::cerr << "Failed to start PortAudio stream: " << Pa_GetErrorText(err) << std::endl;
-        Pa_CloseStream(stream_);
-        Pa_Terminate();
+    if (!output_->start()) {
+        output_->close();
+        output_.reset();
         return false;
     }
 
@@ -64,7 +53,12 @@ bool AudioPlayer::initialize() {
     }
 
     initialized_ = true;
-    std::cout << "Audio player initialized (sample rate: " << sampleRate_ << " Hz)" << std::endl;
+    std::cout << "Audio player initialized (sample rate: " << sampleRate_ << " Hz";
+    if (converter_) {
+        std::cout << ", converted to " << outputRate_ << " Hz ("
+                  << simdKernelName(converter_->kernel()) << ")";
+    }
+    std::cout << ", " << output_->name() << " " << output_->sampleFormat() << " output)" << std::endl;
     
     return true;
 }
@@ -72,16 +66,14 @@ bool AudioPlayer::initialize() {
 void AudioPlayer::shutdown() {
     if (!initialized_) return;
 
-    if (stream_) {
-        Pa_StopStream(stream_);
-        Pa_CloseStream(stream_);
-        stream_ = nullptr;
+    if (output_) {
+        output_->stop();
+        output_->close();
+        output_.reset();
     }
 
-    Pa_Terminate();
-
     // Finalize WAV file
-    if (wavFile_) {
+    if (wavWriter_) {
         finalizeWavFile();
     }
 
@@ -90,144 +82,210 @@ void AudioPlayer::shutdown() {
 }
 
 bool AudioPlayer::addAudioData(const std::vector<int16_t>& samples) {
-    if (!initialized_ || samples.empty()) return false;
+    return addAudioData(samples.data(), samples.size());
+}
 
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    
-    // Check queue size limit
-    if (audioQueue_.size() + samples.size() > MAX_QUEUE_SIZE) {
-        // Drop oldest samples to make room
-        size_t dropCount = (audioQueue_.size() + samples.size()) - MAX_QUEUE_SIZE;
-        for (size_t i = 0; i < dropCount && !audioQueue_.empty(); ++i) {
-            audioQueue_.pop();
-        }
-        std::cout << "Warning: Audio buffer overflow, dropped " << dropCount << " samples" << std::endl;
+bool AudioPlayer::addAudioData(const int16_t* samples, size_t count) {
+    if (!initialized_ || count == 0) return false;
+
+    for (size_t offset = 0; offset < count; offset += CONVERT_BLOCK) {
+        size_t block = std::min(CONVERT_BLOCK, count - offset);
+        int16ToFloat(samples + offset, floatBlock_.data(), block);
+        processBlock(floatBlock_.data(), block);
     }
 
-    // Add new samples to queue
-    for (int16_t sample : samples) {
-        audioQueue_.push(sample);
+    // Save to file if enabled; the writer thread does the disk I/O
+    if (wavWriter_) {
+        wavWriter_->write(samples, count);
     }
 
-    // Save to file if enabled
-    if (wavFile_) {
-        fileBuffer_.insert(fileBuffer_.end(), samples.begin(), samples.end());
+    return true;
+}
+
+bool AudioPlayer::addAudioData(const float* samples, size_t count) {
+    if (!initialized_ || count == 0) return false;
+
+    for (size_t offset = 0; offset < count; offset += CONVERT_BLOCK) {
+        size_t block = std::min(CONVERT_BLOCK, count - offset);
+        if (wavWriter_) {
+            floatToInt16(samples + offset, pcmBlock_.data(), block);
+            wavWriter_->write(pcmBlock_.data(), block);
+        }
+        std::copy(samples + offset, samples + offset + block, floatBlock_.begin());
+        processBlock(floatBlock_.data(), block);
     }
 
-    queueCondition_.notify_one();
     return true;
 }
 
+void AudioPlayer::processBlock(float* samples, size_t count) {
+    if (gain_ != 1.0f) {
+        applyGain(samples, count, gain_);
+    }
+
+    if (converter_) {
+        size_t produced = converter_->process(samples, count, converted_.data());
+        enqueue(converted_.data(), produced);
+    } else {
+        enqueue(samples, count);
+    }
+}
+
+void AudioPlayer::enqueue(const float* samples, size_t count) {
+    // The callback owns the read side of the ring, so samples that do not fit
+    // are dropped here rather than evicting the oldest queued audio
+    samplesOffered_.add(count);
+    size_t written = audioQueue_.write(samples, count);
+    if (written < count) {
+        samplesOverflowed_.add(count - written);
+        Logger::instance().log(Logger::Event::AudioOverflow, static_cast<int64_t>(count - written));
+    }
+}
+
 void AudioPlayer::flush() {
-    if (wavFile_ && !fileBuffer_.empty()) {
-        wavFile_->write(reinterpret_cast<const char*>(fileBuffer_.data()), 
-                       fileBuffer_.size() * sizeof(int16_t));
-        totalSamplesWritten_ += fileBuffer_.size();
-        fileBuffer_.clear();
+    if (wavWriter_) {
+        wavWriter_->flush();
     }
 }
 
 size_t AudioPlayer::getQueueSize() const {
-    std::lock_guard<std::mutex> lock(queueMutex_);
     return audioQueue_.size();
 }
 
-int AudioPlayer::audioCallback(const void* inputBuffer, void* outputBuffer,
-                              unsigned long framesPerBuffer,
-                              const PaStreamCallbackTimeInfo* timeInfo,
-                              PaStreamCallbackFlags statusFlags,
-                              void* userData) {
-    (void)inputBuffer;  // Unused
-    (void)timeInfo;     // Unused
-    (void)statusFlags;  // Unused
+AudioPlayer::Statistics AudioPlayer::getStatistics() const {
+    Statistics stats;
+    stats.underruns = underruns_.load();
+    stats.samplesOverflowed = samplesOverflowed_.load();
+    stats.queuedSamples = audioQueue_.size();
+    stats.clockDriftPpm = clockDriftPpm_.load(std::memory_order_relaxed);
+    stats.playbackRatio = playbackRatio_.load(std::memory_order_relaxed);
+    return stats;
+}
 
+void AudioPlayer::audioCallback(float* output, size_t frameCount, double outputTime, void* userData) {
     AudioPlayer* player = static_cast<AudioPlayer*>(userData);
-    int16_t* output = static_cast<int16_t*>(outputBuffer);
+    auto callbackStart = std::chrono::steady_clock::now();
+    player->queueDepth_.record(player->audioQueue_.size());
+
+    int samplesProvided = player->fillAudioBuffer(output, frameCount);
+
+    // An underrun is audio running out mid-stream; staying silent while
+    // nothing is being received is not counted again
+    bool starved = samplesProvided < static_cast<int>(frameCount);
+    if (starved && (samplesProvided > 0 || !player->starved_)) {
+        player->underruns_.add();
+    }
+    player->starved_ = starved;
 
-    int samplesProvided = player->fillAudioBuffer(output, framesPerBuffer);
+    if (player->driftCompensation_) {
+        player->updateDrift(outputTime, frameCount, starved);
+    }
     
     // Fill remaining buffer with silence if needed
-    if (samplesProvided < static_cast<int>(framesPerBuffer)) {
-        std::memset(output + samplesProvided, 0, 
-                   (framesPerBuffer - samplesProvided) * sizeof(int16_t));
+    if (starved) {
+        std::fill(output + samplesProvided, output + frameCount, 0.0f);
     }
 
-    return paContinue;
+    player->callbackDuration_.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - callbackStart).count()));
 }
 
-int AudioPlayer::fillAudioBuffer(int16_t* output, unsigned long frameCount) {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    
-    unsigned long samplesProvided = 0;
-    
-    while (samplesProvided < frameCount && !audioQueue_.empty()) {
-        output[samplesProvided] = audioQueue_.front();
-        audioQueue_.pop();
-        samplesProvided++;
+int AudioPlayer::fillAudioBuffer(float* output, unsigned long frameCount) {
+    if (!driftCompensation_) {
+        // Lock-free bulk copy out of the ring; never blocks the real-time thread
+        size_t samplesProvided = audioQueue_.read(output, frameCount);
+        return static_cast<int>(samplesProvided);
     }
-    
-    return static_cast<int>(samplesProvided);
-}
 
-void AudioPlayer::initializeWavFile() {
-    wavFile_ = std::make_unique<std::ofstream>(saveFile_, std::ios::binary);
-    if (!wavFile_->is_open()) {
-        std::cerr << "Failed to open WAV file: " << saveFile_ << std::endl;
-        wavFile_.reset();
-        return;
+    // Same, through the resampler, taking only as much input as the current
+    // ratio needs
+    size_t provided = 0;
+    while (provided < frameCount) {
+        size_t block = std::min<size_t>(frameCount - provided, RESAMPLE_BLOCK);
+        size_t needed = std::min(resampler_.inputNeeded(block, ratio_), resampleInput_.size());
+        size_t got = audioQueue_.read(resampleInput_.data(), needed);
+        size_t produced = resampler_.process(resampleInput_.data(), got, output + provided, block, ratio_);
+        provided += produced;
+        if (produced < block) break;
     }
-
-    writeWavHeader();
-    totalSamplesWritten_ = 0;
-    std::cout << "Saving audio to: " << saveFile_ << std::endl;
+    return static_cast<int>(provided);
 }
 
-void AudioPlayer::writeWavHeader() {
-    if (!wavFile_) return;
+void AudioPlayer::updateDrift(double outputTime, size_t frameCount, bool starved) {
+    framesRendered_ += frameCount;
 
-    // WAV header structure
-    struct WavHeader {
-        char riff[4] = {'R', 'I', 'F', 'F'};
-        uint32_t fileSize = 0;  // Will be updated later
-        char wave[4] = {'W', 'A', 'V', 'E'};
-        char fmt[4] = {'f', 'm', 't', ' '};
-        uint32_t fmtSize = 16;
-        uint16_t audioFormat = 1;  // PCM
-        uint16_t numChannels = 1;  // Mono
-        uint32_t sampleRate;
-        uint32_t byteRate;
-        uint16_t blockAlign = 2;   // 16-bit mono
-        uint16_t bitsPerSample = 16;
-        char data[4] = {'d', 'a', 't', 'a'};
-        uint32_t dataSize = 0;     // Will be updated later
-    } header;
+    // A long silence means the sender stopped; whoever comes next has its
+    // own clock and its own starting depth
+    if (starved) {
+        framesStarved_ += frameCount;
+        if (framesStarved_ >= outputRate_) {
+            resetDrift();
+        }
+        return;
+    }
+    framesStarved_ = 0.0;
+
+    // Position of the sender's timeline (samples offered, including ones
+    // dropped on overflow) against the device clock. Backends whose time
+    // info is not available report 0; count rendered frames instead. Where
+    // the reported time follows the system clock rather than the sample
+    // clock, the depth correction below takes up the difference.
+    double deviceTime = outputTime > 0.0 ? outputTime : framesRendered_ / outputRate_;
+    drift_.update(deviceTime, static_cast<double>(samplesOffered_.load()));
+
+    double depth = static_cast<double>(audioQueue_.size() + resampler_.buffered());
+    if (framesStreamed_ == 0.0) {
+        depthFiltered_ = depth;
+    }
+    depthFiltered_ += (depth - depthFiltered_) * std::min(1.0, frameCount / (outputRate_ * DEPTH_SMOOTHING_S));
+    framesStreamed_ += frameCount;
 
-    header.sampleRate = sampleRate_;
-    header.byteRate = sampleRate_ * 2;  // Sample rate * channels * bytes per sample
+    if (!depthLocked_ && framesStreamed_ >= DEPTH_LOCK_S * outputRate_) {
+        depthTarget_ = depthFiltered_;
+        depthLocked_ = true;
+    }
 
-    wavFile_->write(reinterpret_cast<const char*>(&header), sizeof(header));
-}
+    double estimate = 1.0;
+    if (drift_.isValid()) {
+        estimate = std::clamp(drift_.rate() / outputRate_, 1.0 - MAX_RATIO_DEVIATION, 1.0 + MAX_RATIO_DEVIATION);
+    }
+    double correction = depthLocked_ ? (depthFiltered_ - depthTarget_) / (outputRate_ * DEPTH_CORRECTION_S) : 0.0;
+    ratio_ = std::clamp(estimate + correction, 1.0 - MAX_RATIO_DEVIATION, 1.0 + MAX_RATIO_DEVIATION);
 
-void AudioPlayer::finalizeWavFile() {
-    if (!wavFile_) return;
+    clockDriftPpm_.store((estimate - 1.0) * 1e6, std::memory_order_relaxed);
+    playbackRatio_.store(ratio_, std::memory_order_relaxed);
+}
 
-    // Write any remaining buffer data
-    flush();
+void AudioPlayer::resetDrift() {
+    drift_.reset();
+    ratio_ = 1.0;
+    framesStreamed_ = 0.0;
+    framesStarved_ = 0.0;
+    depthLocked_ = false;
+    playbackRatio_.store(1.0, std::memory_order_relaxed);
+}
 
-    // Update WAV header with correct sizes
-    uint32_t dataSize = totalSamplesWritten_ * sizeof(int16_t);
-    uint32_t fileSize = dataSize + 36;  // Total file size - 8 bytes
+void AudioPlayer::initializeWavFile() {
+    wavWriter_ = std::make_unique<WavFileWriter>(sampleRate_);
+    if (!wavWriter_->open(saveFile_)) {
+        wavWriter_.reset();
+        return;
+    }
 
-    // Seek to file size field and update
-    wavFile_->seekp(4);
-    wavFile_->write(reinterpret_cast<const char*>(&fileSize), 4);
+    std::cout << "Saving audio to: " << saveFile_ << std::endl;
+}
 
-    // Seek to data size field and update
-    wavFile_->seekp(40);
-    wavFile_->write(reinterpret_cast<const char*>(&dataSize), 4);
+void AudioPlayer::finalizeWavFile() {
+    if (!wavWriter_) return;
 
-    wavFile_->close();
-    wavFile_.reset();
+    // Writes any remaining buffer data and the final header
+    wavWriter_->close();
 
-    std::cout << "WAV file finalized: " << totalSamplesWritten_ << " samples written" << std::endl;
-}
\ No newline at end of file
+    std::cout << "WAV file finalized: " << wavWriter_->getSamplesWritten() << " samples written" << std::endl;
+    if (wavWriter_->getSamplesDropped() > 0) {
+        std::cout << "Warning: " << wavWriter_->getSamplesDropped()
+                  << " samples not recorded, disk writes fell behind" << std::endl;
+    }
+    wavWriter_.reset();
+}
@@ -0,0 +1,62 @@
+#include "AudioStream.h"
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+AudioStream::AudioStream(const sockaddr_in& source, int sampleRate,
+                         const JitterBuffer::Config& jitterConfig, bool adaptiveDelay,
+                         PacketBufferPool* pool)
+    : source(source), parser(sampleRate), jitterBuffer(sampleRate, jitterConfig) {
+    parser.setBufferPool(pool);
+    jitterBuffer.setBufferPool(pool);
+    if (adaptiveDelay) {
+        delayController = std::make_unique<PlayoutDelayController>(jitterConfig.targetDelayMs);
+        jitterBuffer.setTargetDelay(delayController->getTargetDelayMs());
+    }
+    name = formatAddress(source);
+}
+
+uint64_t AudioStream::makeKey(const sockaddr_in& source) {
+    return (static_cast<uint64_t>(ntohl(source.sin_addr.s_addr)) << 16) | ntohs(source.sin_port);
+}
+
+sockaddr_in AudioStream::addressFromKey(uint64_t key) {
+    sockaddr_in source{};
+    source.sin_family = AF_INET;
+    source.sin_addr.s_addr = htonl(static_cast<uint32_t>(key >> 16));
+    source.sin_port = htons(static_cast<uint16_t>(key));
+    return source;
+}
+
+std::string AudioStream::formatAddress(const sockaddr_in& source) {
+    char address[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &source.sin_addr, address, sizeof(address));
+    return std::string(address) + ":" + std::to_string(ntohs(source.sin_port));
+}
+
+void AudioStream::publishStatistics() {
+    const auto& parserStats = parser.getStats();
+    const auto& jitterStats = jitterBuffer.getStats();
+
+    StreamCounters stats;
+    stats.packetsReceived = parserStats.totalReceived;
+    stats.packetsDropped = parserStats.totalDropped;
+    stats.packetsOutOfOrder = parserStats.outOfOrder;
+    stats.packetsLate = jitterStats.packetsLate;
+    stats.packetsDuplicate = jitterStats.packetsDuplicate;
+    stats.samplesConcealed = jitterStats.samplesConcealed;
+    stats.bytesReceived = bytesReceived;
+    stats.jitterMs = parser.getJitterMs();
+    stats.targetDelayMs = jitterBuffer.getTargetDelayMs();
+    counters.store(stats);
+}
+
+StreamStatistics AudioStream::getStatistics() const {
+    StreamStatistics stats;
+    static_cast<StreamCounters&>(stats) = counters.load();
+    stats.source = name;
+    return stats;
+}
@@ -0,0 +1,57 @@
+#include "ClockDriftEstimator.h"
+#include <cmath>
+
+ClockDriftEstimator::ClockDriftEstimator(double timeConstantSeconds, double minSpanSeconds)
+    : timeConstant_(timeConstantSeconds), minSpan_(minSpanSeconds) {
+}
+
+void ClockDriftEstimator::reset() {
+    started_ = false;
+    sw_ = sx_ = sy_ = sxx_ = sxy_ = 0.0;
+}
+
+void ClockDriftEstimator::update(double time, double position) {
+    if (!started_) {
+        started_ = true;
+        firstTime_ = lastTime_ = originTime_ = time;
+        originPosition_ = position;
+    }
+
+    double elapsed = time - lastTime_;
+    if (elapsed < 0.0) return;  // Reference clock stepped back; skip the point
+    lastTime_ = time;
+
+    double decay = std::exp(-elapsed / timeConstant_);
+    double x = time - originTime_;
+    double y = position - originPosition_;
+    sw_ = sw_ * decay + 1.0;
+    sx_ = sx_ * decay + x;
+    sy_ = sy_ * decay + y;
+    sxx_ = sxx_ * decay + x * x;
+    sxy_ = sxy_ * decay + x * y;
+
+    // Keep x and y small so the sums do not lose precision over long runs
+    if (x > 4.0 * timeConstant_) {
+        recenter(x, y);
+    }
+}
+
+void ClockDriftEstimator::recenter(double dx, double dy) {
+    sxx_ = sxx_ - 2.0 * dx * sx_ + sw_ * dx * dx;
+    sxy_ = sxy_ - dx * sy_ - dy * sx_ + sw_ * dx * dy;
+    sx_ -= sw_ * dx;
+    sy_ -= sw_ * dy;
+    originTime_ += dx;
+    originPosition_ += dy;
+}
+
+bool ClockDriftEstimator::isValid() const {
+    return started_ && lastTime_ - firstTime_ >= minSpan_;
+}
+
+double ClockDriftEstimator::rate() const {
+    if (!isValid()) return 0.0;
+    double denominator = sw_ * sxx_ - sx_ * sx_;
+    if (denominator <= 0.0) return 0.0;
+    return (sw_ * sxy_ - sx_ * sy_) / denominator;
+}
@@ -0,0 +1,148 @@
+#include "DatagramReceiver.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#endif
+
+DatagramReceiver::DatagramReceiver(size_t batchSize, size_t bufferSize)
+    : batchSize_(batchingSupported() ? std::max<size_t>(batchSize, 1) : 1),
+      bufferSize_(bufferSize),
+      storage_(batchSize_ * bufferSize_),
+      datagrams_(batchSize_) {
+#ifdef __linux__
+    messages_.resize(batchSize_);
+    iovecs_.resize(batchSize_);
+    controlWords_ = (CMSG_SPACE(sizeof(timespec)) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    control_.resize(batchSize_ * controlWords_);
+    for (size_t i = 0; i < batchSize_; ++i) {
+        iovecs_[i].iov_base = storage_.data() + i * bufferSize_;
+        iovecs_[i].iov_len = bufferSize_;
+        datagrams_[i].data = storage_.data() + i * bufferSize_;
+    }
+#else
+    datagrams_[0].data = storage_.data();
+#endif
+}
+
+bool DatagramReceiver::enableKernelTimestamps(SocketHandle socket) {
+#ifdef __linux__
+    int enable = 1;
+    return setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+#else
+    (void)socket;
+    return false;
+#endif
+}
+
+bool DatagramReceiver::batchingSupported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+int DatagramReceiver::receive(SocketHandle socket) {
+#ifdef _WIN32
+    Datagram& datagram = datagrams_[0];
+    int addrLen = sizeof(datagram.source);
+    int bytesReceived = recvfrom(static_cast<SOCKET>(socket),
+                                 reinterpret_cast<char*>(storage_.data()),
+                                 static_cast<int>(bufferSize_), 0,
+                                 reinterpret_cast<sockaddr*>(&datagram.source), &addrLen);
+    if (bytesReceived == SOCKET_ERROR) {
+        return WSAGetLastError() == WSAETIMEDOUT ? 0 : -1;
+    }
+    datagram.length = static_cast<size_t>(bytesReceived);
+    datagram.arrival = Clock::now();
+    return 1;
+#elif defined(__linux__)
+    // The kernel overwrites lengths on return, so reset the headers each call
+    for (size_t i = 0; i < batchSize_; ++i) {
+        resetMessage(i);
+    }
+
+    int count;
+    if (batchSize_ == 1) {
+        ssize_t bytesReceived = recvmsg(socket, &messages_[0].msg_hdr, 0);
+        count = bytesReceived < 0 ? -1 : 1;
+        if (count == 1) {
+            messages_[0].msg_len = static_cast<unsigned int>(bytesReceived);
+        }
+    } else {
+        // Wait for the first datagram, then take whatever else is already queued
+        count = recvmmsg(socket, messages_.data(), static_cast<unsigned int>(batchSize_),
+                         MSG_WAITFORONE, nullptr);
+    }
+    if (count < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    // Kernel timestamps are CLOCK_REALTIME; map them onto the steady clock
+    // using one offset sample per call
+    Clock::time_point now = Clock::now();
+    timespec realtime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    int64_t realtimeNs = static_cast<int64_t>(realtime.tv_sec) * 1000000000LL + realtime.tv_nsec;
+    int64_t steadyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+
+    for (int i = 0; i < count; ++i) {
+        datagrams_[i].length = messages_[i].msg_len;
+        extractTimestamp(static_cast<size_t>(i), now, steadyNs - realtimeNs);
+    }
+    return count;
+#else
+    Datagram& datagram = datagrams_[0];
+    socklen_t addrLen = sizeof(datagram.source);
+    ssize_t bytesReceived = recvfrom(socket, storage_.data(), bufferSize_, 0,
+                                     reinterpret_cast<sockaddr*>(&datagram.source), &addrLen);
+    if (bytesReceived < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    datagram.length = static_cast<size_t>(bytesReceived);
+    datagram.arrival = Clock::now();
+    return 1;
+#endif
+}
+
+#ifdef __linux__
+void DatagramReceiver::resetMessage(size_t index) {
+    msghdr& hdr = messages_[index].msg_hdr;
+    hdr.msg_name = &datagrams_[index].source;
+    hdr.msg_namelen = sizeof(datagrams_[index].source);
+    hdr.msg_iov = &iovecs_[index];
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control_.data() + index * controlWords_;
+    hdr.msg_controllen = controlWords_ * sizeof(uint64_t);
+    hdr.msg_flags = 0;
+    messages_[index].msg_len = 0;
+}
+
+void DatagramReceiver::extractTimestamp(size_t index, Clock::time_point now, int64_t realtimeToSteadyNs) {
+    Datagram& datagram = datagrams_[index];
+    datagram.arrival = now;
+    datagram.kernelTimestamp = false;
+
+    msghdr& hdr = messages_[index].msg_hdr;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts;
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            int64_t kernelNs = static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+            auto arrival = Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+                std::chrono::nanoseconds(kernelNs + realtimeToSteadyNs)));
+            // Guard against the offset sample landing on a realtime clock step
+            datagram.arrival = std::min(arrival, now);
+            datagram.kernelTimestamp = true;
+            break;
+        }
+    }
+}
+#endif
@@ -0,0 +1,55 @@
+#include "FractionalResampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+FractionalResampler::FractionalResampler(size_t maxInput)
+    : fifo_(maxInput + 4, 0.0f) {
+    reset();
+}
+
+void FractionalResampler::reset() {
+    // One sample of silence before the first input
+    fifo_[0] = 0.0f;
+    fill_ = 1;
+    position_ = 1.0;
+}
+
+size_t FractionalResampler::inputNeeded(size_t frames, double ratio) const {
+    if (frames == 0) return 0;
+    // The last output interpolates up to two samples past its position
+    size_t last = static_cast<size_t>(position_ + (frames - 1) * ratio) + 3;
+    return last > fill_ ? last - fill_ : 0;
+}
+
+size_t FractionalResampler::process(const float* input, size_t count, float* output, size_t frames,
+                                    double ratio) {
+    count = std::min(count, fifo_.size() - fill_);
+    std::copy(input, input + count, fifo_.begin() + fill_);
+    fill_ += count;
+
+    size_t produced = 0;
+    for (; produced < frames; ++produced) {
+        size_t i = static_cast<size_t>(position_);
+        if (i + 2 >= fill_) break;
+
+        float f = static_cast<float>(position_ - i);
+        float x0 = fifo_[i - 1], x1 = fifo_[i], x2 = fifo_[i + 1], x3 = fifo_[i + 2];
+        float c1 = 0.5f * (x2 - x0);
+        float c2 = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3;
+        float c3 = 0.5f * (x3 - x0) + 1.5f * (x1 - x2);
+        float y = ((c3 * f + c2) * f + c1) * f + x1;
+        output[produced] = y;
+
+        position_ += ratio;
+    }
+
+    // Drop what no later output can reach, keeping one sample behind the position
+    size_t drop = std::min(static_cast<size_t>(position_) - 1, fill_ - 1);
+    if (drop > 0) {
+        std::memmove(fifo_.data(), fifo_.data() + drop, (fill_ - drop) * sizeof(float));
+        fill_ -= drop;
+        position_ -= drop;
+    }
+    return produced;
+}
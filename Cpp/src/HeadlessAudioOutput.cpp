@@ -0,0 +1,98 @@
+#include "HeadlessAudioOutput.h"
+#include "SampleConversion.h"
+#include <iostream>
+
+ClockedAudioOutput::~ClockedAudioOutput() {
+    stop();
+}
+
+bool ClockedAudioOutput::open(int sampleRate, size_t framesPerBuffer, RenderCallback callback, void* userData) {
+    if (sampleRate <= 0 || framesPerBuffer == 0) {
+        std::cerr << "Invalid output parameters" << std::endl;
+        return false;
+    }
+
+    sampleRate_ = sampleRate;
+    framesPerBuffer_ = framesPerBuffer;
+    callback_ = callback;
+    userData_ = userData;
+    buffer_.assign(framesPerBuffer, 0.0f);
+    return true;
+}
+
+bool ClockedAudioOutput::start() {
+    if (running_.load()) return true;
+
+    buffersRendered_.store(0, std::memory_order_relaxed);
+    running_.store(true);
+    thread_ = std::thread(&ClockedAudioOutput::clockThread, this);
+    return true;
+}
+
+void ClockedAudioOutput::stop() {
+    running_.store(false);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ClockedAudioOutput::close() {
+    stop();
+}
+
+void ClockedAudioOutput::clockThread() {
+    Clock::time_point start = Clock::now();
+    uint64_t framesRendered = 0;
+
+    while (running_.load()) {
+        // Deadlines are computed from the start time, never from the last
+        // wakeup, so oversleeping in one period is made up in the next
+        double seconds = static_cast<double>(framesRendered) / sampleRate_;
+        Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                                 std::chrono::duration<double>(seconds));
+        std::this_thread::sleep_until(deadline);
+
+        callback_(buffer_.data(), framesPerBuffer_, seconds, userData_);
+        consume(buffer_.data(), framesPerBuffer_);
+
+        framesRendered += framesPerBuffer_;
+        buffersRendered_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void NullAudioOutput::consume(const float* samples, size_t count) {
+    (void)samples;
+    (void)count;
+}
+
+FileAudioOutput::FileAudioOutput(const std::string& path, bool dither)
+    : path_(path), dither_(dither) {
+}
+
+bool FileAudioOutput::open(int sampleRate, size_t framesPerBuffer, RenderCallback callback, void* userData) {
+    file_ = std::make_unique<std::ofstream>(path_, std::ios::binary);
+    if (!file_->is_open()) {
+        std::cerr << "Failed to open output file: " << path_ << std::endl;
+        file_.reset();
+        return false;
+    }
+    pcm_.assign(framesPerBuffer, 0);
+    return ClockedAudioOutput::open(sampleRate, framesPerBuffer, callback, userData);
+}
+
+void FileAudioOutput::close() {
+    ClockedAudioOutput::close();
+    if (file_) {
+        file_->close();
+        file_.reset();
+    }
+}
+
+void FileAudioOutput::consume(const float* samples, size_t count) {
+    if (dither_) {
+        floatToInt16Dithered(samples, pcm_.data(), count, ditherSeed_);
+    } else {
+        floatToInt16(samples, pcm_.data(), count);
+    }
+    file_->write(reinterpret_cast<const char*>(pcm_.data()), count * sizeof(int16_t));
+}
@@ -0,0 +1,68 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+void Histogram::Snapshot::merge(const Snapshot& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
+
+uint64_t Histogram::Snapshot::percentile(double quantile) const {
+    if (count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * count));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            // The bucket's upper edge overstates by at most one step; never
+            // report more than was actually recorded
+            return std::min(bucketValue(i), max);
+        }
+    }
+    return max;
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot result;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        result.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        result.count += result.counts[i];
+    }
+    result.sum = sum_.load(std::memory_order_relaxed);
+    result.max = max_.load(std::memory_order_relaxed);
+    return result;
+}
+
+uint64_t Histogram::bucketValue(size_t index) {
+    if (index < 2 * SUB_BUCKETS) return index;
+    size_t shift = index / SUB_BUCKETS - 1;
+    uint64_t mantissa = index - shift * SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+std::string formatHistogramText(const Histogram::Snapshot& snapshot, double scale, const char* unit) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "p50 %.3f  p99 %.3f  p99.9 %.3f  max %.3f %s (n=%llu)",
+                  snapshot.percentile(0.50) / scale, snapshot.percentile(0.99) / scale,
+                  snapshot.percentile(0.999) / scale, snapshot.max / scale, unit,
+                  static_cast<unsigned long long>(snapshot.count));
+    return line;
+}
+
+std::string formatHistogramJson(const Histogram::Snapshot& snapshot, double scale) {
+    char json[200];
+    std::snprintf(json, sizeof(json),
+                  "{\"count\":%llu,\"mean\":%.6g,\"p50\":%.6g,\"p99\":%.6g,\"p999\":%.6g,\"max\":%.6g}",
+                  static_cast<unsigned long long>(snapshot.count), snapshot.mean() / scale,
+                  snapshot.percentile(0.50) / scale, snapshot.percentile(0.99) / scale,
+                  snapshot.percentile(0.999) / scale, snapshot.max / scale);
+    return json;
+}
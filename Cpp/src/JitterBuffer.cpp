@@ -0,0 +1,278 @@
+#include "JitterBuffer.h"
+#include <algorithm>
+
+JitterBuffer::JitterBuffer(int sampleRate)
+    : JitterBuffer(sampleRate, Config{}) {
+}
+
+JitterBuffer::JitterBuffer(int sampleRate, const Config& config)
+    : sampleRate_(sampleRate), config_(config), concealer_(sampleRate, config.concealment),
+      playoutRate_(sampleRate) {
+    setTargetDelay(config_.targetDelayMs);
+    reorderWindowSamples_ = static_cast<int64_t>(config_.reorderWindowMs * sampleRate_ / 1000.0);
+    concealBuffer_.assign(static_cast<size_t>(std::max(1, sampleRate_ * CONCEAL_CHUNK_MS / 1000)), 0);
+}
+
+bool JitterBuffer::insert(const AudioPacketView& packet, Clock::time_point arrival) {
+    int64_t timestamp;
+    size_t skip;
+    if (!admit(packet.sampleTimestamp, packet.sampleCount, arrival, timestamp, skip)) {
+        return false;
+    }
+
+    size_t count = packet.sampleCount - skip;
+    PacketBuffer samples = pool_ ? pool_->acquire(count) : PacketBufferPool::allocate(count);
+    packet.copySamples(samples.data(), skip, count);
+    store(timestamp, std::move(samples), arrival);
+    return true;
+}
+
+bool JitterBuffer::insert(AudioPacket&& packet, Clock::time_point arrival) {
+    int64_t timestamp;
+    size_t skip;
+    if (!admit(packet.sampleTimestamp, packet.audioSamples.size(), arrival, timestamp, skip)) {
+        return false;
+    }
+
+    packet.audioSamples.trimFront(skip);
+    store(timestamp, std::move(packet.audioSamples), arrival);
+    return true;
+}
+
+bool JitterBuffer::admit(uint32_t sampleTimestamp, size_t sampleCount, Clock::time_point arrival,
+                         int64_t& timestamp, size_t& skip) {
+    if (sampleCount == 0) return false;
+
+    if (!started_) {
+        cursor_ = sampleTimestamp;
+        anchor(cursor_, arrival);
+        clockOrigin_ = arrival;
+        lastRateUpdate_ = arrival;
+        started_ = true;
+    }
+
+    timestamp = unwrapTimestamp(sampleTimestamp);
+    int64_t end = timestamp + static_cast<int64_t>(sampleCount);
+
+    // A jump outside the reorder window in either direction means the sender
+    // restarted or we lost a long stretch; start over from this packet
+    if (timestamp - cursor_ > reorderWindowSamples_ || cursor_ - timestamp > reorderWindowSamples_) {
+        while (!packets_.empty()) {
+            recycle(packets_.begin());
+        }
+        cursor_ = timestamp;
+        anchor(timestamp, arrival);
+        stats_.resyncs++;
+
+        // A new timeline; its rate has to be measured again
+        senderClock_.reset();
+        playoutRate_ = sampleRate_;
+        stats_.senderRate = 0.0;
+    }
+
+    if (end <= cursor_) {
+        stats_.packetsLate++;
+        return false;
+    }
+
+    // Partially played out already: keep only the part still ahead of the cursor
+    skip = 0;
+    if (timestamp < cursor_) {
+        skip = static_cast<size_t>(cursor_ - timestamp);
+        timestamp = cursor_;
+    }
+
+    // Buffer ran dry and this packet is already past due: re-anchor so the
+    // target delay is rebuilt instead of playing everything late from now on
+    if (packets_.empty() && arrival > playoutTime(timestamp)) {
+        anchor(timestamp, arrival);
+    }
+
+    if (packets_.count(timestamp) > 0) {
+        stats_.packetsDuplicate++;
+        return false;
+    }
+
+    stats_.packetsInserted++;
+    trackSenderClock(timestamp, arrival);
+    return true;
+}
+
+void JitterBuffer::trackSenderClock(int64_t timestamp, Clock::time_point arrival) {
+    if (!config_.trackSenderClock) return;
+
+    double seconds = std::chrono::duration<double>(arrival - clockOrigin_).count();
+    senderClock_.update(seconds, static_cast<double>(timestamp));
+
+    if (!senderClock_.isValid() || arrival - lastRateUpdate_ < std::chrono::milliseconds(RATE_UPDATE_MS)) {
+        return;
+    }
+    lastRateUpdate_ = arrival;
+
+    double rate = std::clamp(senderClock_.rate(),
+                             sampleRate_ * (1.0 - MAX_RATE_DEVIATION),
+                             sampleRate_ * (1.0 + MAX_RATE_DEVIATION));
+    stats_.senderRate = rate;
+
+    // Re-anchor at the cursor so audio already due keeps its playout time
+    // and only what follows is paced at the new rate
+    anchorTime_ = playoutTime(cursor_) - targetDelay_;
+    anchorTimestamp_ = cursor_;
+    playoutRate_ = rate;
+}
+
+void JitterBuffer::store(int64_t timestamp, PacketBuffer&& samples, Clock::time_point arrival) {
+    // Reuse a map node from an earlier packet when possible
+    PacketMap::node_type node;
+    if (!spareNodes_.empty()) {
+        node = std::move(spareNodes_.back());
+        spareNodes_.pop_back();
+        node.key() = timestamp;
+    } else {
+        // Warming up: allocate a node that will be recycled from now on
+        PacketMap scratch;
+        node = scratch.extract(scratch.emplace(timestamp, Entry{}).first);
+    }
+
+    node.mapped().samples = std::move(samples);
+    node.mapped().arrival = arrival;
+    packets_.insert(std::move(node));
+}
+
+size_t JitterBuffer::releaseChunk(Clock::time_point now, const int16_t*& samples) {
+    Clock::time_point chunkTime;
+    return releaseChunk(now, samples, chunkTime);
+}
+
+size_t JitterBuffer::releaseChunk(Clock::time_point now, const int16_t*& samples, Clock::time_point& chunkTime) {
+    // The previous chunk's storage is free again
+    if (!released_.empty()) {
+        released_.mapped().samples.reset();
+        spareNodes_.push_back(std::move(released_));
+    }
+
+    while (!packets_.empty()) {
+        auto it = packets_.begin();
+        int64_t timestamp = it->first;
+        const PacketBuffer& entrySamples = it->second.samples;
+        int64_t end = timestamp + static_cast<int64_t>(entrySamples.size());
+
+        // Fully covered by audio already released (overlapping packets)
+        if (end <= cursor_) {
+            recycle(it);
+            continue;
+        }
+
+        chunkTime = playoutTime(cursor_);
+        if (now < chunkTime) return 0;
+
+        if (timestamp > cursor_) {
+            // Missing range whose playout time has come
+            size_t count = generateConcealment(static_cast<size_t>(timestamp - cursor_));
+            cursor_ += static_cast<int64_t>(count);
+            samples = concealBuffer_.data();
+            return count;
+        }
+
+        size_t offset = static_cast<size_t>(cursor_ - timestamp);
+        size_t count = entrySamples.size() - offset;
+        released_ = packets_.extract(it);
+        int16_t* chunk = released_.mapped().samples.data() + offset;
+        samples = chunk;
+        // drain() releases with a time of max(), which is not a latency
+        if (latencyHistogram_ && now != Clock::time_point::max() && now > released_.mapped().arrival) {
+            latencyHistogram_->record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - released_.mapped().arrival).count()));
+        }
+        stats_.samplesReleased += count;
+        // May cross-fade the start of the chunk in place after concealment
+        concealer_.play(chunk, count);
+        cursor_ = end;
+        return count;
+    }
+
+    return 0;
+}
+
+size_t JitterBuffer::release(Clock::time_point now, std::vector<int16_t>& out) {
+    size_t appended = 0;
+    const int16_t* samples;
+    while (size_t count = releaseChunk(now, samples)) {
+        out.insert(out.end(), samples, samples + count);
+        appended += count;
+    }
+    return appended;
+}
+
+std::optional<JitterBuffer::Clock::time_point> JitterBuffer::nextReleaseTime() const {
+    if (packets_.empty()) return std::nullopt;
+    return playoutTime(cursor_);
+}
+
+size_t JitterBuffer::drain(std::vector<int16_t>& out) {
+    return release(Clock::time_point::max(), out);
+}
+
+void JitterBuffer::setTargetDelay(double ms) {
+    ms = std::max(0.0, ms);
+
+    // Shrinking the delay skips the playout cursor forward by the difference
+    // so release timing stays continuous and latency actually drops, and the
+    // concealer cross-fades across the skip instead of cutting; growing it
+    // simply pauses release until the new playout time
+    if (started_ && ms < config_.targetDelayMs) {
+        int64_t skip = static_cast<int64_t>((config_.targetDelayMs - ms) * sampleRate_ / 1000.0);
+        if (skip > 0) {
+            cursor_ += skip;
+            concealer_.splice();
+        }
+    }
+
+    config_.targetDelayMs = ms;
+    targetDelay_ = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(config_.targetDelayMs));
+}
+
+void JitterBuffer::reset() {
+    while (!packets_.empty()) {
+        recycle(packets_.begin());
+    }
+    stats_ = Stats{};
+    started_ = false;
+    cursor_ = 0;
+    concealer_.reset();
+    senderClock_.reset();
+    playoutRate_ = sampleRate_;
+}
+
+int64_t JitterBuffer::unwrapTimestamp(uint32_t timestamp) const {
+    // Interpret the 32-bit timestamp as the nearest value to the cursor
+    int32_t delta = static_cast<int32_t>(timestamp - static_cast<uint32_t>(cursor_));
+    return cursor_ + delta;
+}
+
+JitterBuffer::Clock::time_point JitterBuffer::playoutTime(int64_t timestamp) const {
+    double offsetSeconds = static_cast<double>(timestamp - anchorTimestamp_) / playoutRate_;
+    return anchorTime_ + targetDelay_ +
+           std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(offsetSeconds));
+}
+
+void JitterBuffer::anchor(int64_t timestamp, Clock::time_point arrival) {
+    anchorTimestamp_ = timestamp;
+    anchorTime_ = arrival;
+}
+
+void JitterBuffer::recycle(PacketMap::iterator it) {
+    // The packet buffer goes back to its pool; only the node is kept
+    PacketMap::node_type node = packets_.extract(it);
+    node.mapped().samples.reset();
+    spareNodes_.push_back(std::move(node));
+}
+
+size_t JitterBuffer::generateConcealment(size_t count) {
+    // Long gaps are produced one buffer-full at a time
+    count = std::min(count, concealBuffer_.size());
+    stats_.samplesConcealed += count;
+    concealer_.conceal(concealBuffer_.data(), count);
+    return count;
+}
@@ -0,0 +1,132 @@
+#include "Logger.h"
+#include <iostream>
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() = default;
+
+Logger::~Logger() {
+    stop();
+}
+
+void Logger::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&Logger::writerThread, this);
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // The writer has stopped; pick up anything queued after its last pass
+    writeQueued();
+    if (getSuppressed() > 0) {
+        std::cout << "Log messages suppressed by rate limit: " << getSuppressed() << '\n';
+    }
+    std::cout.flush();
+}
+
+void Logger::log(Event event, int64_t a, int64_t b, int64_t c) {
+    if (event >= Event::Count) return;
+
+    Record record{event, a, b, c, 0};
+    if (!admit(limits_[static_cast<size_t>(event)], record.suppressedBefore)) {
+        return;
+    }
+
+    if (!running_.load(std::memory_order_relaxed) || !queue_.tryPush(record)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool Logger::admit(RateLimit& limit, uint64_t& suppressedBefore) {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+
+    // Whoever notices the window has expired opens the next one
+    int64_t windowStart = limit.windowStart.load(std::memory_order_relaxed);
+    if (now - windowStart >= 1000000000LL &&
+        limit.windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        limit.count.store(0, std::memory_order_relaxed);
+    }
+
+    if (limit.count.fetch_add(1, std::memory_order_relaxed) < RATE_LIMIT_PER_SECOND) {
+        suppressedBefore = limit.suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    limit.suppressed.fetch_add(1, std::memory_order_relaxed);
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Logger::writerThread() {
+    while (running_.load()) {
+        if (writeQueued() > 0) {
+            std::cout.flush();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+        }
+    }
+}
+
+size_t Logger::writeQueued() {
+    size_t written = 0;
+    Record record;
+    while (queue_.tryPop(record)) {
+        format(record);
+        written++;
+    }
+    return written;
+}
+
+void Logger::format(const Record& record) {
+    std::ostream& out = std::cout;
+
+    switch (record.event) {
+    case Event::PacketsDropped:
+        out << "Warning: " << record.a << " packet(s) dropped (seq "
+            << record.b << " to " << record.c << ")";
+        break;
+    case Event::PacketOutOfOrder:
+        out << "Warning: Out of order packet (seq " << record.a
+            << ", expected " << record.b << ")";
+        break;
+    case Event::InvalidPacketLength:
+        out << "Warning: Invalid audio data length " << record.a << " (must be even)";
+        break;
+    case Event::AudioOverflow:
+        out << "Warning: Audio buffer overflow, dropped " << record.a << " samples";
+        break;
+    case Event::StreamAdded:
+        out << "New stream from ";
+        formatAddress(out, record.a, record.b);
+        break;
+    case Event::StreamRemoved:
+        out << "Stream ";
+        formatAddress(out, record.a, record.b);
+        out << " idle, removed";
+        break;
+    case Event::StreamPlaying:
+        out << "Playing stream from ";
+        formatAddress(out, record.a, record.b);
+        break;
+    case Event::Count:
+        return;
+    }
+
+    if (record.suppressedBefore > 0) {
+        out << " (" << record.suppressedBefore << " similar suppressed)";
+    }
+    out << '\n';
+}
+
+void Logger::formatAddress(std::ostream& out, int64_t address, int64_t port) {
+    out << ((address >> 24) & 0xff) << '.' << ((address >> 16) & 0xff) << '.'
+        << ((address >> 8) & 0xff) << '.' << (address & 0xff) << ':' << port;
+}
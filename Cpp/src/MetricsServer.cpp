@@ -0,0 +1,188 @@
+#include "MetricsServer.h"
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+void closeSocket(uintptr_t sock) { closesocket(static_cast<SOCKET>(sock)); }
+#else
+void closeSocket(int sock) { close(sock); }
+#endif
+
+// A scraper hanging up mid-response must not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+}  // namespace
+
+MetricsServer::MetricsServer(RenderFunction render)
+    : render_(std::move(render)) {
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(int port) {
+    if (running_.load()) return true;
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
+    if (result != 0) {
+        std::cerr << "WSAStartup failed: " << result << std::endl;
+        return false;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        std::cerr << "Metrics socket creation failed: " << WSAGetLastError() << std::endl;
+        WSACleanup();
+        return false;
+    }
+    listenSocket_ = sock;
+#else
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        perror("Metrics socket creation failed");
+        return false;
+    }
+    listenSocket_ = sock;
+#endif
+
+    // Restarting right after a scrape must not fail on TIME_WAIT
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(sock, 8) != 0) {
+#ifdef _WIN32
+        std::cerr << "Metrics bind/listen failed: " << WSAGetLastError() << std::endl;
+#else
+        perror("Metrics bind/listen failed");
+#endif
+        closeListenSocket();
+        return false;
+    }
+
+    running_.store(true);
+    thread_ = std::thread(&MetricsServer::serverThread, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closeListenSocket();
+}
+
+void MetricsServer::closeListenSocket() {
+#ifdef _WIN32
+    if (listenSocket_ != 0) {
+        closeSocket(listenSocket_);
+        listenSocket_ = 0;
+        WSACleanup();
+    }
+#else
+    if (listenSocket_ >= 0) {
+        closeSocket(listenSocket_);
+        listenSocket_ = -1;
+    }
+#endif
+}
+
+void MetricsServer::serverThread() {
+    while (running_.load()) {
+        // Wait for a connection with a timeout so stop() is noticed promptly
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listenSocket_, &readable);
+        timeval timeout{0, ACCEPT_TIMEOUT_MS * 1000};
+
+        int ready = select(static_cast<int>(listenSocket_ + 1), &readable, nullptr, nullptr, &timeout);
+        if (ready <= 0) continue;
+
+#ifdef _WIN32
+        SOCKET client = accept(static_cast<SOCKET>(listenSocket_), nullptr, nullptr);
+        if (client == INVALID_SOCKET) continue;
+        DWORD clientTimeout = CLIENT_TIMEOUT_MS;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&clientTimeout, sizeof(clientTimeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, (const char*)&clientTimeout, sizeof(clientTimeout));
+#else
+        int client = accept(listenSocket_, nullptr, nullptr);
+        if (client < 0) continue;
+        timeval clientTimeout{CLIENT_TIMEOUT_MS / 1000, (CLIENT_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &clientTimeout, sizeof(clientTimeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &clientTimeout, sizeof(clientTimeout));
+#endif
+
+        handleConnection(static_cast<SocketHandle>(client));
+        closeSocket(static_cast<SocketHandle>(client));
+    }
+}
+
+void MetricsServer::handleConnection(SocketHandle client) {
+    // Read until the end of the request headers; the body, if any, is ignored
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_SIZE) {
+        int received = static_cast<int>(recv(client, buffer, sizeof(buffer), 0));
+        if (received <= 0) break;
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::string status;
+    std::string contentType = "text/plain; charset=utf-8";
+    std::string body;
+    size_t lineEnd = request.find("\r\n");
+    std::string requestLine = request.substr(0, lineEnd);
+
+    if (requestLine.rfind("GET ", 0) != 0) {
+        status = "405 Method Not Allowed";
+        body = "Only GET is supported\n";
+    } else if (requestLine.rfind("GET /metrics ", 0) == 0 || requestLine.rfind("GET /metrics?", 0) == 0) {
+        status = "200 OK";
+        contentType = "text/plain; version=0.0.4; charset=utf-8";
+        body = render_();
+    } else {
+        status = "404 Not Found";
+        body = "Metrics are served at /metrics\n";
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\n" +
+                           "Content-Type: " + contentType + "\r\n" +
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                           "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        int n = static_cast<int>(send(client, response.data() + sent,
+                                      static_cast<int>(response.size() - sent), SEND_FLAGS));
+        if (n <= 0) break;
+        sent += static_cast<size_t>(n);
+    }
+    requestsServed_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,143 @@
+#include "PacketBufferPool.h"
+#include <utility>
+
+PacketBuffer::PacketBuffer(PacketBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+PacketBuffer& PacketBuffer::operator=(PacketBuffer&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool_ = other.pool_;
+        storage_ = other.storage_;
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        index_ = other.index_;
+
+        other.pool_ = nullptr;
+        other.storage_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+        other.index_ = NOT_POOLED;
+    }
+    return *this;
+}
+
+void PacketBuffer::trimFront(size_t count) {
+    if (count > size_) count = size_;
+    data_ += count;
+    size_ -= count;
+    capacity_ -= count;
+}
+
+void PacketBuffer::reset() {
+    if (storage_ == nullptr) return;
+
+    if (index_ != NOT_POOLED) {
+        pool_->release(index_);
+    } else {
+        delete[] storage_;
+    }
+
+    pool_ = nullptr;
+    storage_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+    index_ = NOT_POOLED;
+}
+
+PacketBufferPool::PacketBufferPool(size_t bufferSamples, size_t bufferCount, size_t maxBufferCount)
+    : bufferSamples_(bufferSamples), slabBuffers_(bufferCount),
+      maxSlabs_(bufferCount == 0 ? 0
+                : maxBufferCount > bufferCount ? (maxBufferCount + bufferCount - 1) / bufferCount
+                : 1),
+      slabs_(new std::unique_ptr<int16_t[]>[maxSlabs_]),
+      next_(new std::atomic<uint32_t>[maxSlabs_ * slabBuffers_]) {
+    if (maxSlabs_ > 0) {
+        addSlab();
+    }
+}
+
+void PacketBufferPool::reserve(size_t bufferCount) {
+    std::lock_guard<std::mutex> lock(growMutex_);
+    while (bufferCount_.load(std::memory_order_relaxed) < bufferCount &&
+           bufferCount_.load(std::memory_order_relaxed) < maxSlabs_ * slabBuffers_) {
+        addSlab();
+    }
+}
+
+void PacketBufferPool::addSlab() {
+    size_t first = bufferCount_.load(std::memory_order_relaxed);
+    size_t last = first + slabBuffers_ - 1;
+    slabs_[first / slabBuffers_].reset(new int16_t[bufferSamples_ * slabBuffers_]);
+
+    // Chain the slab's buffers in address order, then push the chain onto
+    // the free list in one step
+    for (size_t i = first; i < last; ++i) {
+        next_[i].store(static_cast<uint32_t>(i + 1), std::memory_order_relaxed);
+    }
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        next_[last].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | static_cast<uint32_t>(first);
+    } while (!head_.compare_exchange_weak(head, next, std::memory_order_release,
+                                          std::memory_order_relaxed));
+
+    bufferCount_.store(last + 1, std::memory_order_relaxed);
+    available_.fetch_add(slabBuffers_, std::memory_order_relaxed);
+}
+
+int16_t* PacketBufferPool::bufferAt(uint32_t index) const {
+    return slabs_[index / slabBuffers_].get() + (index % slabBuffers_) * bufferSamples_;
+}
+
+PacketBuffer PacketBufferPool::acquire(size_t samples) {
+    if (samples <= bufferSamples_) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (static_cast<uint32_t>(head) != EMPTY) {
+            uint32_t index = static_cast<uint32_t>(head);
+            uint64_t tag = (head >> 32) + 1;
+            uint64_t next = (tag << 32) | next_[index].load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, next, std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+                available_.fetch_sub(1, std::memory_order_relaxed);
+
+                PacketBuffer buffer;
+                buffer.pool_ = this;
+                buffer.index_ = index;
+                buffer.storage_ = bufferAt(index);
+                buffer.data_ = buffer.storage_;
+                buffer.capacity_ = bufferSamples_;
+                buffer.size_ = samples;
+                return buffer;
+            }
+        }
+    }
+
+    fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    return allocate(samples);
+}
+
+PacketBuffer PacketBufferPool::allocate(size_t samples) {
+    PacketBuffer buffer;
+    buffer.storage_ = new int16_t[samples > 0 ? samples : 1];
+    buffer.data_ = buffer.storage_;
+    buffer.capacity_ = samples;
+    buffer.size_ = samples;
+    return buffer;
+}
+
+void PacketBufferPool::release(uint32_t index) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | index;
+    } while (!head_.compare_exchange_weak(head, next, std::memory_order_release,
+                                          std::memory_order_relaxed));
+    available_.fetch_add(1, std::memory_order_relaxed);
+}
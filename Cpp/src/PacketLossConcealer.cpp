@@ -0,0 +1,372 @@
+#include "PacketLossConcealer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+int16_t toSample(float value) {
+    return static_cast<int16_t>(std::clamp(value, -32768.0f, 32767.0f));
+}
+
+}  // namespace
+
+PacketLossConcealer::PacketLossConcealer(int sampleRate, Mode mode)
+    : sampleRate_(std::max(1, sampleRate)), mode_(mode), gapMode_(mode) {
+    minPitch_ = std::max<size_t>(2, static_cast<size_t>(sampleRate_ * MIN_PITCH_MS / 1000));
+    maxPitch_ = std::max(minPitch_ + 1, static_cast<size_t>(sampleRate_ * MAX_PITCH_MS / 1000));
+    correlationLength_ = std::max<size_t>(LPC_ORDER + 1, static_cast<size_t>(sampleRate_ * CORRELATION_MS / 1000));
+    size_t repeatLength = std::max<size_t>(1, static_cast<size_t>(sampleRate_ * REPEAT_MS / 1000));
+
+    // Enough for the pitch search, three periods plus the LPC filter's
+    // memory, and the RepeatLast period
+    historySize_ = std::max({maxPitch_ + correlationLength_, 3 * maxPitch_ + LPC_ORDER, repeatLength});
+    history_.assign(2 * historySize_, 0.0f);
+    historyEnd_ = historySize_;
+
+    pitchBuffer_.assign(std::max(3 * maxPitch_, repeatLength), 0.0f);
+    lpc_.assign(LPC_ORDER, 0.0f);
+    lpcMemory_.assign(LPC_ORDER, 0.0f);
+    lpcWindow_.resize(correlationLength_);
+    for (size_t i = 0; i < correlationLength_; ++i) {
+        lpcWindow_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * (i + 0.5) / correlationLength_));
+    }
+    scratch_.assign(std::max(SCRATCH_SIZE, correlationLength_), 0.0f);
+}
+
+void PacketLossConcealer::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    historyEnd_ = historySize_;
+    historyFill_ = 0;
+    concealing_ = false;
+    splicing_ = false;
+}
+
+void PacketLossConcealer::play(int16_t* samples, size_t count) {
+    if (count == 0) return;
+
+    if (concealing_) {
+        // Fade from the concealment's continuation into the real audio. The
+        // longer the loss, the further the two have drifted apart, so the
+        // longer the fade (G.711 Appendix I: 4 ms more per 10 ms of loss).
+        if (gapMode_ == Mode::Waveform || gapMode_ == Mode::Lpc) {
+            size_t fourMs = static_cast<size_t>(sampleRate_) / 250;
+            size_t tenMs = static_cast<size_t>(sampleRate_) / 100;
+            size_t merge = std::max(overlap_, fourMs) + (tenMs > 0 ? concealed_ / tenMs : 0) * fourMs;
+            merge = std::min({merge, static_cast<size_t>(sampleRate_ * MAX_MERGE_MS / 1000), count, scratch_.size()});
+
+            generate(scratch_.data(), merge);
+            float step = 1.0f / (merge + 1);
+            for (size_t i = 0; i < merge; ++i) {
+                float w = (i + 1) * step;
+                samples[i] = toSample(samples[i] * w + scratch_[i] * (1.0f - w));
+            }
+        }
+        concealing_ = false;
+        splicing_ = false;
+    }
+
+    for (size_t done = 0; done < count;) {
+        size_t n = std::min(count - done, scratch_.size());
+        for (size_t i = 0; i < n; ++i) {
+            scratch_[i] = samples[done + i];
+        }
+        appendHistory(scratch_.data(), n);
+        done += n;
+    }
+}
+
+void PacketLossConcealer::conceal(int16_t* out, size_t count) {
+    // A real gap straight after a splice is concealed the configured way
+    if (!concealing_ || (splicing_ && gapMode_ != mode_)) {
+        startGap(mode_);
+    }
+    splicing_ = false;
+
+    for (size_t done = 0; done < count;) {
+        size_t n = std::min(count - done, scratch_.size());
+        generate(scratch_.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            out[done + i] = toSample(scratch_[i]);
+        }
+        // Concealed audio is history too, so a loss right after this one
+        // continues from what was actually played
+        appendHistory(scratch_.data(), n);
+        done += n;
+    }
+}
+
+void PacketLossConcealer::splice() {
+    // Silence and RepeatLast would fade in from silence or a 20 ms old
+    // repeat; the pitch-synchronous continuation joins without a click
+    if (!concealing_) {
+        startGap(mode_ == Mode::Lpc ? Mode::Lpc : Mode::Waveform);
+        splicing_ = true;
+    }
+}
+
+void PacketLossConcealer::appendHistory(const float* samples, size_t count) {
+    if (count >= historySize_) {
+        std::memcpy(history_.data(), samples + count - historySize_, historySize_ * sizeof(float));
+        historyEnd_ = historySize_;
+    } else {
+        // Slide the window back to the front only when it reaches the end,
+        // so appending is a plain copy most of the time
+        if (historyEnd_ + count > history_.size()) {
+            std::memmove(history_.data(), history_.data() + historyEnd_ - historySize_,
+                         historySize_ * sizeof(float));
+            historyEnd_ = historySize_;
+        }
+        std::memcpy(history_.data() + historyEnd_, samples, count * sizeof(float));
+        historyEnd_ += count;
+    }
+    historyFill_ = std::min(historySize_, historyFill_ + count);
+}
+
+void PacketLossConcealer::startGap(Mode mode) {
+    concealing_ = true;
+    gapMode_ = mode;
+    silent_ = false;
+    concealed_ = 0;
+    periods_ = 1;
+    pos_ = 0;
+    fadeRemaining_ = 0;
+    overlap_ = 0;
+    repeatGain_ = 1.0f;
+
+    switch (gapMode_) {
+    case Mode::Silence:
+        silent_ = true;
+        return;
+
+    case Mode::RepeatLast: {
+        size_t repeatLength = std::max<size_t>(1, static_cast<size_t>(sampleRate_ * REPEAT_MS / 1000));
+        if (historyFill_ < repeatLength) {
+            silent_ = true;
+            return;
+        }
+        pitch_ = repeatLength;
+        std::memcpy(pitchBuffer_.data(), historyEnd() - pitch_, pitch_ * sizeof(float));
+        return;
+    }
+
+    case Mode::Waveform:
+    case Mode::Lpc:
+        break;
+    }
+
+    if (historyFill_ < historySize_) {
+        silent_ = true;
+        return;
+    }
+
+    pitch_ = findPitchPeriod();
+    overlap_ = std::max<size_t>(1, pitch_ / 4);
+    const float* source = historyEnd() - 3 * pitch_;
+
+    if (gapMode_ == Mode::Waveform) {
+        std::memcpy(pitchBuffer_.data(), source, 3 * pitch_ * sizeof(float));
+        return;
+    }
+
+    // Lpc: cycle the prediction residual and let the synthesis filter,
+    // primed with the last real samples, restore the spectral envelope.
+    // Without a usable fit the filter is the identity and this is Waveform.
+    computeLpc();
+    for (size_t n = 0; n < 3 * pitch_; ++n) {
+        float residual = source[n];
+        for (size_t k = 0; k < LPC_ORDER; ++k) {
+            residual += lpc_[k] * source[n - k - 1];
+        }
+        pitchBuffer_[n] = residual;
+    }
+    for (size_t k = 0; k < LPC_ORDER; ++k) {
+        lpcMemory_[k] = historyEnd()[-static_cast<std::ptrdiff_t>(k) - 1];
+    }
+}
+
+size_t PacketLossConcealer::findPitchPeriod() const {
+    // Maximize the normalized correlation between the last correlationLength_
+    // samples and the same span `lag` earlier; coarse steps of one 8 kHz
+    // sample first, then every lag around the best coarse one
+    const float* target = historyEnd() - correlationLength_;
+    size_t coarseStep = std::max(1, sampleRate_ / 8000);
+
+    auto score = [&](size_t lag) {
+        const float* candidate = target - lag;
+        float correlation = dot(target, candidate, correlationLength_);
+        float energy = dot(candidate, candidate, correlationLength_) + 1.0f;
+        float normalized = correlation * correlation / energy;
+        return correlation > 0 ? normalized : -normalized;
+    };
+
+    size_t best = maxPitch_;
+    float bestScore = score(best);
+    for (size_t lag = minPitch_; lag < maxPitch_; lag += coarseStep) {
+        float s = score(lag);
+        if (s > bestScore) {
+            bestScore = s;
+            best = lag;
+        }
+    }
+
+    size_t low = best > minPitch_ + coarseStep ? best - coarseStep + 1 : minPitch_;
+    size_t high = std::min(maxPitch_, best + coarseStep - 1);
+    size_t coarse = best;
+    for (size_t lag = low; lag <= high; ++lag) {
+        if (lag == coarse) continue;
+        float s = score(lag);
+        if (s > bestScore) {
+            bestScore = s;
+            best = lag;
+        }
+    }
+    return best;
+}
+
+bool PacketLossConcealer::computeLpc() {
+    std::fill(lpc_.begin(), lpc_.end(), 0.0f);
+
+    // Autocorrelation of the Hann-windowed last correlationLength_ samples
+    const float* x = historyEnd() - correlationLength_;
+    float* windowed = scratch_.data();
+    for (size_t i = 0; i < correlationLength_; ++i) {
+        windowed[i] = x[i] * lpcWindow_[i];
+    }
+
+    double r[LPC_ORDER + 1];
+    for (size_t k = 0; k <= LPC_ORDER; ++k) {
+        r[k] = dot(windowed, windowed + k, correlationLength_ - k);
+    }
+    if (r[0] < 1.0) return false;
+    r[0] *= 1.0001;  // White noise correction keeps the filter well conditioned
+
+    // Levinson-Durbin recursion
+    double a[LPC_ORDER + 1] = {1.0};
+    double previous[LPC_ORDER + 1];
+    double error = r[0];
+    for (size_t i = 1; i <= LPC_ORDER; ++i) {
+        double acc = r[i];
+        for (size_t j = 1; j < i; ++j) {
+            acc += a[j] * r[i - j];
+        }
+        double reflection = -acc / error;
+
+        std::copy(a, a + i, previous);
+        for (size_t j = 1; j < i; ++j) {
+            a[j] = previous[j] + reflection * previous[i - j];
+        }
+        a[i] = reflection;
+
+        error *= 1.0 - reflection * reflection;
+        if (error <= 0.0) return false;
+    }
+
+    // Bandwidth expansion widens the formant peaks so the decaying
+    // excitation does not ring
+    double expansion = 1.0;
+    for (size_t k = 1; k <= LPC_ORDER; ++k) {
+        expansion *= 0.99;
+        lpc_[k - 1] = static_cast<float>(a[k] * expansion);
+    }
+    return true;
+}
+
+float PacketLossConcealer::readPeriods(size_t periods, size_t& pos) const {
+    size_t length = periods * pitch_;
+    float value = pitchBuffer_[3 * pitch_ - length + pos];
+    if (++pos >= length) pos = 0;
+    return value;
+}
+
+float PacketLossConcealer::nextSample() {
+    if (gapMode_ == Mode::RepeatLast) {
+        float value = pitchBuffer_[pos_] * repeatGain_;
+        if (++pos_ >= pitch_) {
+            pos_ = 0;
+            repeatGain_ *= 0.5f;
+        }
+        concealed_++;
+        return value;
+    }
+
+    // Cycle two, then three periods after 10 and 20 ms so a long loss sounds
+    // less buzzy; the old and new cycles are overlap-added over 1/4 period
+    size_t tenMs = static_cast<size_t>(sampleRate_) / 100;
+    if (tenMs > 0 && periods_ < 3 && concealed_ == periods_ * tenMs) {
+        fadePos_ = pos_;
+        periods_++;
+        fadeRemaining_ = overlap_;
+    }
+
+    float value = readPeriods(periods_, pos_);
+    if (fadeRemaining_ > 0) {
+        float w = static_cast<float>(fadeRemaining_) / (overlap_ + 1);
+        value = value * (1.0f - w) + readPeriods(periods_ - 1, fadePos_) * w;
+        fadeRemaining_--;
+    }
+
+    size_t attenuationStart = static_cast<size_t>(sampleRate_ * ATTENUATION_START_MS / 1000);
+    if (concealed_ >= attenuationStart) {
+        float span = static_cast<float>(sampleRate_) * (ATTENUATION_END_MS - ATTENUATION_START_MS) / 1000.0f;
+        value *= std::max(0.0f, 1.0f - (concealed_ - attenuationStart) / span);
+    }
+
+    if (gapMode_ == Mode::Lpc) {
+        float output = value;
+        for (size_t k = 0; k < LPC_ORDER; ++k) {
+            output -= lpc_[k] * lpcMemory_[k];
+        }
+        std::memmove(lpcMemory_.data() + 1, lpcMemory_.data(), (LPC_ORDER - 1) * sizeof(float));
+        lpcMemory_[0] = output;
+        value = output;
+    }
+
+    concealed_++;
+    return value;
+}
+
+void PacketLossConcealer::generate(float* out, size_t count) {
+    if (silent_) {
+        std::fill(out, out + count, 0.0f);
+        concealed_ += count;
+        return;
+    }
+
+    size_t i = 0;
+    if (gapMode_ == Mode::Waveform) {
+        // Until the first period change the output is a straight copy of
+        // the last period, done in contiguous runs
+        size_t tenMs = static_cast<size_t>(sampleRate_) / 100;
+        while (i < count && periods_ == 1 && concealed_ < tenMs) {
+            size_t run = std::min({count - i, pitch_ - pos_, tenMs - concealed_});
+            std::memcpy(out + i, pitchBuffer_.data() + 2 * pitch_ + pos_, run * sizeof(float));
+            pos_ = (pos_ + run) % pitch_;
+            concealed_ += run;
+            i += run;
+        }
+    }
+
+    for (; i < count; ++i) {
+        out[i] = nextSample();
+    }
+}
+
+float PacketLossConcealer::dot(const float* a, const float* b, size_t n) {
+    // Independent partial sums let the compiler vectorize the reduction
+    // without reassociating floating point itself
+    float sums[8] = {};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t j = 0; j < 8; ++j) {
+            sums[j] += a[i + j] * b[i + j];
+        }
+    }
+    float total = ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+    for (; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
@@ -1,51 +1,82 @@
 #include "PacketParser.h"
+#include "Logger.h"
 #include <cstring>
-#include <iostream>
+#include <cmath>
 
-PacketParser::PacketParser() {
+PacketParser::PacketParser(int sampleRate)
+    : sampleRate_(sampleRate) {
     resetStats();
 }
 
 std::optional<AudioPacket> PacketParser::parsePacket(const uint8_t* data, size_t length) {
-    // Minimum packet size: 2 bytes seq + 4 bytes timestamp + at least 2 bytes audio
-    if (length < 8 || data == nullptr) {
+    return parsePacket(data, length, Clock::now());
+}
+
+std::optional<AudioPacket> PacketParser::parsePacket(const uint8_t* data, size_t length,
+                                                     Clock::time_point arrival) {
+    auto view = parseView(data, length, arrival);
+    if (!view.has_value()) {
+        return std::nullopt;
+    }
+
+    PacketBuffer audioSamples = pool_ ? pool_->acquire(view->sampleCount)
+                                      : PacketBufferPool::allocate(view->sampleCount);
+    view->copySamples(audioSamples.data(), 0, view->sampleCount);
+
+    AudioPacket packet(view->sequenceNumber, view->sampleTimestamp, std::move(audioSamples));
+    packet.arrivalTimeNs = view->arrivalTimeNs;
+    return packet;
+}
+
+std::optional<AudioPacketView> PacketParser::parseView(const uint8_t* data, size_t length,
+                                                       Clock::time_point arrival) {
+    if (!isWellFormed(data, length)) {
         return std::nullopt;
     }
 
     // Parse header: [2 bytes seq#][4 bytes sample_timestamp]
-    uint16_t sequenceNumber;
-    uint32_t sampleTimestamp;
+    AudioPacketView view;
     
     // Read little-endian values
-    std::memcpy(&sequenceNumber, data, 2);
-    std::memcpy(&sampleTimestamp, data + 2, 4);
+    std::memcpy(&view.sequenceNumber, data, 2);
+    std::memcpy(&view.sampleTimestamp, data + 2, 4);
     
     // Convert from little-endian if necessary (assuming host is little-endian for simplicity)
     // In production, use proper endianness conversion functions
     
-    // Extract audio data
+    // Audio data follows the header
     size_t audioDataLength = length - 6;  // Remaining bytes after header
     
-    // Audio data must be even number of bytes (16-bit samples)
-    if (audioDataLength % 2 != 0) {
-        std::cerr << "Warning: Invalid audio data length " << audioDataLength 
-                  << " (must be even)" << std::endl;
-        return std::nullopt;
-    }
-    
-    size_t numSamples = audioDataLength / 2;
-    std::vector<int16_t> audioSamples(numSamples);
-    
-    // Parse 16-bit little-endian audio samples
-    const uint8_t* audioData = data + 6;
-    for (size_t i = 0; i < numSamples; ++i) {
-        std::memcpy(&audioSamples[i], audioData + (i * 2), 2);
-    }
+    view.payload = data + 6;
+    view.sampleCount = audioDataLength / 2;
+    view.arrivalTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        arrival.time_since_epoch()).count();
     
     // Update statistics
-    updateStatistics(sequenceNumber);
+    bool first = !stats_.firstPacketReceived;
+    updateStatistics(view.sequenceNumber);
+    if (!first) {
+        updateJitter(view.sampleTimestamp, arrival);
+    }
+    lastArrival_ = arrival;
+    lastTimestamp_ = view.sampleTimestamp;
     
-    return AudioPacket(sequenceNumber, sampleTimestamp, std::move(audioSamples));
+    return view;
+}
+
+bool PacketParser::isWellFormed(const uint8_t* data, size_t length) {
+    // Minimum packet size: 2 bytes seq + 4 bytes timestamp + at least 2 bytes audio
+    if (length < 8 || data == nullptr) {
+        return false;
+    }
+
+    // Audio data must be even number of bytes (16-bit samples)
+    size_t audioDataLength = length - 6;
+    if (audioDataLength % 2 != 0) {
+        Logger::instance().log(Logger::Event::InvalidPacketLength, static_cast<int64_t>(audioDataLength));
+        return false;
+    }
+    return true;
 }
 
 void PacketParser::updateStatistics(uint16_t sequenceNumber) {
@@ -71,19 +102,31 @@ void PacketParser::updateStatistics(uint16_t sequenceNumber) {
             }
             
             stats_.totalDropped += dropped;
-            std::cout << "Warning: " << dropped << " packet(s) dropped (seq " 
-                      << expectedSeq << " to " << (sequenceNumber - 1) << ")" << std::endl;
+            Logger::instance().log(Logger::Event::PacketsDropped, dropped, expectedSeq,
+                                   static_cast<uint16_t>(sequenceNumber - 1));
         } else {
             // Out of order packet
             stats_.outOfOrder++;
-            std::cout << "Warning: Out of order packet (seq " << sequenceNumber 
-                      << ", expected " << expectedSeq << ")" << std::endl;
+            Logger::instance().log(Logger::Event::PacketOutOfOrder, sequenceNumber, expectedSeq);
         }
     }
     
     stats_.lastSequenceNumber = sequenceNumber;
 }
 
+void PacketParser::updateJitter(uint32_t sampleTimestamp, Clock::time_point arrival) {
+    // RFC 3550 section 6.4.1: D = (Rj - Ri) - (Sj - Si) in timestamp units,
+    // J += (|D| - J) / 16
+    double arrivalDelta = std::chrono::duration<double>(arrival - lastArrival_).count() * sampleRate_;
+    int32_t timestampDelta = static_cast<int32_t>(sampleTimestamp - lastTimestamp_);
+    double d = arrivalDelta - timestampDelta;
+    stats_.jitter += (std::fabs(d) - stats_.jitter) / 16.0;
+
+    if (jitterHistogram_) {
+        jitterHistogram_->record(static_cast<uint64_t>(std::fabs(d) * 1e9 / sampleRate_));
+    }
+}
+
 bool PacketParser::isSequenceNumberValid(uint16_t current, uint16_t expected) const {
     // Handle wraparound: if expected > 32768 and current < 32768, likely wrapped
     if (expected > 32768 && current < 32768) {
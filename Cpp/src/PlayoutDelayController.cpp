@@ -0,0 +1,48 @@
+#include "PlayoutDelayController.h"
+#include <algorithm>
+
+PlayoutDelayController::PlayoutDelayController(double initialDelayMs)
+    : PlayoutDelayController(initialDelayMs, Config{}) {
+}
+
+PlayoutDelayController::PlayoutDelayController(double initialDelayMs, const Config& config)
+    : config_(config),
+      targetDelayMs_(std::clamp(initialDelayMs, config.minDelayMs, config.maxDelayMs)) {
+}
+
+bool PlayoutDelayController::update(double jitterMs, uint64_t latePackets, Clock::time_point now) {
+    if (!started_) {
+        started_ = true;
+        lastUpdate_ = now;
+        lastLatePackets_ = latePackets;
+        return false;
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - lastUpdate_).count();
+    if (elapsedMs < config_.updateIntervalMs) {
+        return false;
+    }
+    lastUpdate_ = now;
+
+    // Late packets mean the jitter estimate underestimated the tail; keep
+    // extra headroom that decays at the shrink rate
+    if (latePackets > lastLatePackets_) {
+        lateHeadroomMs_ += config_.lateBumpMs;
+    } else {
+        lateHeadroomMs_ = std::max(0.0, lateHeadroomMs_ - config_.shrinkRateMsPerSec * elapsedMs / 1000.0);
+    }
+    lastLatePackets_ = latePackets;
+
+    double desired = config_.jitterMultiplier * jitterMs + config_.marginMs + lateHeadroomMs_;
+    desired = std::clamp(desired, config_.minDelayMs, config_.maxDelayMs);
+
+    double previous = targetDelayMs_;
+    if (desired > targetDelayMs_) {
+        targetDelayMs_ = desired;
+    } else {
+        double maxStep = config_.shrinkRateMsPerSec * elapsedMs / 1000.0;
+        targetDelayMs_ = std::max(desired, targetDelayMs_ - maxStep);
+    }
+
+    return targetDelayMs_ != previous;
+}
@@ -0,0 +1,190 @@
+#include "PolyphaseResampler.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace {
+
+// All kernels take n as a multiple of 8
+
+float dotScalar(const float* a, const float* b, size_t n) {
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (size_t i = 0; i < n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+#ifdef AUDIO_SIMD_SSE2
+float dotSse2(const float* a, const float* b, size_t n) {
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 s = _mm_add_ps(s0, s1);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+#ifdef AUDIO_SIMD_X86
+AUDIO_TARGET_AVX2
+float dotAvx2(const float* a, const float* b, size_t n) {
+    // Two accumulators hide the FMA latency on the typical 32-128 tap rows
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+    }
+    if (i < n) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+    }
+    __m256 s = _mm256_add_ps(s0, s1);
+    __m128 h = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+    h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+    h = _mm_add_ss(h, _mm_shuffle_ps(h, h, 1));
+    return _mm_cvtss_f32(h);
+}
+#endif
+
+#ifdef AUDIO_SIMD_NEON
+float dotNeon(const float* a, const float* b, size_t n) {
+    float32x4_t s0 = vdupq_n_f32(0.0f);
+    float32x4_t s1 = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < n; i += 8) {
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vmlaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t s = vaddq_f32(s0, s1);
+    return (vgetq_lane_f32(s, 0) + vgetq_lane_f32(s, 1)) + (vgetq_lane_f32(s, 2) + vgetq_lane_f32(s, 3));
+}
+#endif
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+}  // namespace
+
+bool PolyphaseResampler::isSupported(int inputRate, int outputRate) {
+    if (inputRate <= 0 || outputRate <= 0) return false;
+    int divisor = std::gcd(inputRate, outputRate);
+    size_t up = static_cast<size_t>(outputRate / divisor);
+    return up * MAX_TAPS <= MAX_COEFFICIENTS;
+}
+
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate, size_t maxInput, Kernel kernel)
+    : maxInput_(maxInput) {
+    int divisor = std::gcd(inputRate, outputRate);
+    up_ = outputRate / divisor;
+    down_ = inputRate / divisor;
+
+    kernel_ = resolveSimdKernel(kernel);
+    switch (kernel_) {
+#ifdef AUDIO_SIMD_SSE2
+    case Kernel::Sse2: dot_ = dotSse2; break;
+#endif
+#ifdef AUDIO_SIMD_X86
+    case Kernel::Avx2: dot_ = dotAvx2; break;
+#endif
+#ifdef AUDIO_SIMD_NEON
+    case Kernel::Neon: dot_ = dotNeon; break;
+#endif
+    default: dot_ = dotScalar; break;
+    }
+
+    designFilter();
+    maxOutput_ = (maxInput_ * up_ + down_ - 1) / down_ + 1;
+    window_.assign(taps_ - 1 + maxInput_, 0.0f);
+}
+
+void PolyphaseResampler::designFilter() {
+    // Prototype at up_ times the input rate, in radians per prototype sample.
+    // Kaiser's length estimate for the transition between the passband edge
+    // and the lower rate's Nyquist frequency.
+    const double pi = 3.14159265358979323846;
+    double nyquist = pi / std::max(up_, down_);
+    double transition = (1.0 - PASSBAND) * nyquist;
+    double cutoff = (1.0 + PASSBAND) / 2.0 * nyquist;
+    double length = std::ceil((STOPBAND_DB - 8.0) / (2.285 * transition)) + 1.0;
+
+    taps_ = static_cast<size_t>(std::ceil(length / up_));
+    taps_ = std::min(MAX_TAPS, (taps_ + 7) / 8 * 8);
+    size_t total = taps_ * static_cast<size_t>(up_);
+
+    double beta = 0.1102 * (STOPBAND_DB - 8.7);
+    double center = (total - 1) / 2.0;
+    double i0Beta = besselI0(beta);
+    std::vector<double> prototype(total);
+    for (size_t n = 0; n < total; ++n) {
+        double t = n - center;
+        double sinc = t == 0.0 ? cutoff / pi : std::sin(cutoff * t) / (pi * t);
+        double r = t / center;
+        prototype[n] = sinc * besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+    }
+
+    // Split into phases, reversed so the newest input meets the last tap.
+    // Each phase is scaled to unity DC gain, which removes the ripple an
+    // upsampler otherwise shows at the input rate.
+    coefficients_.assign(total, 0.0f);
+    for (size_t p = 0; p < static_cast<size_t>(up_); ++p) {
+        float* row = &coefficients_[p * taps_];
+        double sum = 0.0;
+        for (size_t k = 0; k < taps_; ++k) {
+            sum += prototype[p + k * up_];
+        }
+        for (size_t k = 0; k < taps_; ++k) {
+            row[taps_ - 1 - k] = static_cast<float>(prototype[p + k * up_] / sum);
+        }
+    }
+}
+
+double PolyphaseResampler::latencySamples() const {
+    return (static_cast<double>(taps_) * up_ - 1.0) / 2.0 / up_;
+}
+
+void PolyphaseResampler::reset() {
+    std::fill(window_.begin(), window_.end(), 0.0f);
+    phase_ = 0;
+    position_ = 0;
+}
+
+size_t PolyphaseResampler::process(const float* in, size_t count, float* out) {
+    count = std::min(count, maxInput_);
+    std::copy(in, in + count, window_.begin() + (taps_ - 1));
+
+    // Output n sits at n * down_ / up_ input samples: the integer part is the
+    // newest input it sees, the remainder picks the phase
+    size_t produced = 0;
+    size_t up = static_cast<size_t>(up_);
+    size_t down = static_cast<size_t>(down_);
+    while (position_ < count) {
+        out[produced++] = dot_(&coefficients_[phase_ * taps_], window_.data() + position_, taps_);
+
+        phase_ += down;
+        position_ += phase_ / up;
+        phase_ %= up;
+    }
+    position_ -= count;
+
+    // Keep the newest taps_ - 1 inputs as history for the next block
+    std::copy(window_.begin() + count, window_.begin() + count + (taps_ - 1), window_.begin());
+    return produced;
+}
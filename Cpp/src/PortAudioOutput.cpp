@@ -0,0 +1,144 @@
+#include "PortAudioOutput.h"
+#include "SampleConversion.h"
+#include <algorithm>
+#include <iostream>
+
+PortAudioOutput::PortAudioOutput(AudioOutputConfig::SampleFormat format, bool dither)
+    : requestedFormat_(format), dither_(dither) {
+}
+
+PortAudioOutput::~PortAudioOutput() {
+    close();
+}
+
+bool PortAudioOutput::deviceAvailable() {
+    if (Pa_Initialize() != paNoError) return false;
+    bool available = Pa_GetDefaultOutputDevice() != paNoDevice;
+    Pa_Terminate();
+    return available;
+}
+
+int PortAudioOutput::nativeSampleRate() const {
+    if (Pa_Initialize() != paNoError) return 0;
+    int rate = 0;
+    PaDeviceIndex device = Pa_GetDefaultOutputDevice();
+    if (device != paNoDevice) {
+        rate = static_cast<int>(Pa_GetDeviceInfo(device)->defaultSampleRate);
+    }
+    Pa_Terminate();
+    return rate;
+}
+
+bool PortAudioOutput::open(int sampleRate, size_t framesPerBuffer, RenderCallback callback, void* userData) {
+    callback_ = callback;
+    userData_ = userData;
+
+    // Initialize PortAudio
+    PaError err = Pa_Initialize();
+    if (err != paNoError) {
+        std::cerr << "PortAudio initialization failed: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+    paInitialized_ = true;
+
+    // Setup output stream parameters
+    PaStreamParameters outputParameters;
+    outputParameters.device = Pa_GetDefaultOutputDevice();
+    if (outputParameters.device == paNoDevice) {
+        std::cerr << "No default output device found" << std::endl;
+        close();
+        return false;
+    }
+
+    outputParameters.channelCount = 1;  // Mono
+    outputParameters.sampleFormat = paFloat32;
+    outputParameters.suggestedLatency = Pa_GetDeviceInfo(outputParameters.device)->defaultLowOutputLatency;
+    outputParameters.hostApiSpecificStreamInfo = nullptr;
+
+    // Float avoids a conversion on most host APIs; int16 when asked for or
+    // when the device will not take float at this rate
+    float_ = requestedFormat_ == AudioOutputConfig::SampleFormat::Float32 ||
+             (requestedFormat_ == AudioOutputConfig::SampleFormat::Auto &&
+              Pa_IsFormatSupported(nullptr, &outputParameters, sampleRate) == paFormatIsSupported);
+    if (!float_) {
+        outputParameters.sampleFormat = paInt16;
+        scratch_.assign(framesPerBuffer, 0.0f);
+    }
+
+    // Open audio stream
+    err = Pa_OpenStream(&stream_,
+                        nullptr,              // no input
+                        &outputParameters,
+                        sampleRate,
+                        static_cast<unsigned long>(framesPerBuffer),
+                        paClipOff,           // no clipping
+                        streamCallback,
+                        this);               // user data
+
+    if (err != paNoError) {
+        std::cerr << "Failed to open PortAudio stream: " << Pa_GetErrorText(err) << std::endl;
+        stream_ = nullptr;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool PortAudioOutput::start() {
+    PaError err = Pa_StartStream(stream_);
+    if (err != paNoError) {
+        std::cerr << "Failed to start PortAudio stream: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PortAudioOutput::stop() {
+    if (stream_) {
+        Pa_StopStream(stream_);
+    }
+}
+
+void PortAudioOutput::close() {
+    if (stream_) {
+        Pa_CloseStream(stream_);
+        stream_ = nullptr;
+    }
+    if (paInitialized_) {
+        Pa_Terminate();
+        paInitialized_ = false;
+    }
+}
+
+int PortAudioOutput::streamCallback(const void* inputBuffer, void* outputBuffer,
+                                    unsigned long framesPerBuffer,
+                                    const PaStreamCallbackTimeInfo* timeInfo,
+                                    PaStreamCallbackFlags statusFlags,
+                                    void* userData) {
+    (void)inputBuffer;  // Unused
+    (void)statusFlags;  // Unused
+
+    PortAudioOutput* self = static_cast<PortAudioOutput*>(userData);
+    double outputTime = timeInfo ? timeInfo->outputBufferDacTime : 0.0;
+    if (self->float_) {
+        self->callback_(static_cast<float*>(outputBuffer), framesPerBuffer, outputTime, self->userData_);
+        return paContinue;
+    }
+
+    // Render into the float scratch buffer a piece at a time, in case the
+    // host ever asks for more than the configured buffer size
+    int16_t* output = static_cast<int16_t*>(outputBuffer);
+    size_t done = 0;
+    while (done < framesPerBuffer) {
+        size_t frames = std::min(self->scratch_.size(), static_cast<size_t>(framesPerBuffer) - done);
+        self->callback_(self->scratch_.data(), frames, outputTime, self->userData_);
+        if (self->dither_) {
+            floatToInt16Dithered(self->scratch_.data(), output + done, frames, self->ditherSeed_);
+        } else {
+            floatToInt16(self->scratch_.data(), output + done, frames);
+        }
+        done += frames;
+    }
+    return paContinue;
+}
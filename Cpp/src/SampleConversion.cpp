@@ -0,0 +1,183 @@
+#include "SampleConversion.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+
+namespace {
+
+constexpr float FLOAT_TO_INT16 = 32768.0f;
+
+// Round half away from zero; the SIMD kernels round half to even, which
+// differs only for values exactly between two integers
+inline int16_t toInt16(float sample) {
+    float scaled = std::clamp(sample * FLOAT_TO_INT16, -32768.0f, 32767.0f);
+    return static_cast<int16_t>(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+void int16ToFloatScalar(const int16_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = in[i] * INT16_TO_FLOAT;
+    }
+}
+
+void floatToInt16Scalar(const float* in, int16_t* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = toInt16(in[i]);
+    }
+}
+
+#ifdef AUDIO_SIMD_SSE2
+void int16ToFloatSse2(const int16_t* in, float* out, size_t count) {
+    const __m128 scale = _mm_set1_ps(INT16_TO_FLOAT);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign-extend by placing each sample in the high half and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+
+void floatToInt16Sse2(const float* in, int16_t* out, size_t count) {
+    // Clamp before converting: out-of-range floats convert to INT32_MIN,
+    // which would saturate to the wrong end. 32768 itself packs to 32767.
+    const __m128 scale = _mm_set1_ps(FLOAT_TO_INT16);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), lo), hi);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    floatToInt16Scalar(in + i, out + i, count - i);
+}
+#endif
+
+#ifdef AUDIO_SIMD_X86
+AUDIO_TARGET_AVX2
+void int16ToFloatAvx2(const int16_t* in, float* out, size_t count) {
+    const __m256 scale = _mm256_set1_ps(INT16_TO_FLOAT);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+
+AUDIO_TARGET_AVX2
+void floatToInt16Avx2(const float* in, int16_t* out, size_t count) {
+    const __m256 scale = _mm256_set1_ps(FLOAT_TO_INT16);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32768.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), lo), hi);
+        // packs works within 128-bit lanes; restore sample order afterwards
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    floatToInt16Scalar(in + i, out + i, count - i);
+}
+#endif
+
+#ifdef AUDIO_SIMD_NEON
+void int16ToFloatNeon(const int16_t* in, float* out, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), INT16_TO_FLOAT));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), INT16_TO_FLOAT));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+#endif
+
+#ifdef AUDIO_SIMD_NEON64
+void floatToInt16Neon(const float* in, int16_t* out, size_t count) {
+    // vqmovn saturates, and the float to int32 conversion does too
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + i), FLOAT_TO_INT16));
+        int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + i + 4), FLOAT_TO_INT16));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    floatToInt16Scalar(in + i, out + i, count - i);
+}
+#endif
+
+struct Kernels {
+    void (*toFloat)(const int16_t*, float*, size_t);
+    void (*toInt16)(const float*, int16_t*, size_t);
+    const char* name;
+};
+
+const Kernels& kernels() {
+    static const Kernels selected = []() -> Kernels {
+#ifdef AUDIO_SIMD_X86
+        if (cpuHasAvx2()) return {int16ToFloatAvx2, floatToInt16Avx2, "avx2"};
+#endif
+#ifdef AUDIO_SIMD_SSE2
+        return {int16ToFloatSse2, floatToInt16Sse2, "sse2"};
+#elif defined(AUDIO_SIMD_NEON64)
+        return {int16ToFloatNeon, floatToInt16Neon, "neon"};
+#elif defined(AUDIO_SIMD_NEON)
+        return {int16ToFloatNeon, floatToInt16Scalar, "neon"};
+#else
+        return {int16ToFloatScalar, floatToInt16Scalar, "scalar"};
+#endif
+    }();
+    return selected;
+}
+
+}  // namespace
+
+void int16ToFloat(const int16_t* in, float* out, size_t count) {
+    kernels().toFloat(in, out, count);
+}
+
+void floatToInt16(const float* in, int16_t* out, size_t count) {
+    kernels().toInt16(in, out, count);
+}
+
+void floatToInt16Dithered(const float* in, int16_t* out, size_t count, uint32_t& seed) {
+    // Add the noise in blocks on the stack, then convert with the fast kernel.
+    // One xorshift draw per sample gives the two uniform values whose
+    // difference is triangular over +-1 LSB.
+    constexpr size_t BLOCK = 256;
+    constexpr float LSB = 1.0f / 65536.0f * INT16_TO_FLOAT;
+    float noisy[BLOCK];
+    uint32_t state = seed ? seed : 1;
+    for (size_t offset = 0; offset < count; offset += BLOCK) {
+        size_t n = std::min(BLOCK, count - offset);
+        for (size_t i = 0; i < n; ++i) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            float triangular = static_cast<float>(static_cast<int32_t>(state & 0xFFFF) -
+                                                  static_cast<int32_t>(state >> 16));
+            noisy[i] = in[offset + i] + triangular * LSB;
+        }
+        kernels().toInt16(noisy, out + offset, n);
+    }
+    seed = state;
+}
+
+void applyGain(float* samples, size_t count, float gain) {
+    // Simple enough for the compiler to vectorize at the baseline ISA
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] *= gain;
+    }
+}
+
+const char* sampleConversionKernel() {
+    return kernels().name;
+}
@@ -1,10 +1,16 @@
 #include "UDPAudioStreamer.h"
 #include "AudioPlayer.h"
-#include "PacketParser.h"
+#include "FlatHashMap.h"
+#include "MetricsServer.h"
 #include <iostream>
+#include <sstream>
 #include <chrono>
 #include <mutex>
+#include <thread>
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -16,19 +22,123 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <cerrno>
+#include <cstdio>
 #endif
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <linux/filter.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// State owned by one receive thread. With SO_REUSEPORT sharding every worker
+// has its own socket on the shared port and its own stream table, so the
+// packet path never touches another worker's data.
+struct UDPAudioStreamer::ReceiveWorker {
+    size_t index = 0;
+
+#ifdef _WIN32
+    uintptr_t socket = 0;  // SOCKET on Windows
+#else
+    int socket = -1;       // file descriptor on Unix
+#endif
+
+#ifdef __linux__
+    // Event loop: socket readiness, shutdown wakeup, playout timer
+    int epollFd = -1;
+    int wakeFd = -1;
+    int timerFd = -1;
+#endif
+
+    std::unique_ptr<DatagramReceiver> receiver;
+    std::thread thread;
+
+    // One pipeline per sender, keyed by AudioStream::makeKey(source address)
+    FlatHashMap<uint64_t, std::unique_ptr<AudioStream>> streams{64};
+    JitterBuffer::Clock::time_point lastEviction;
+
+    // Written only by this worker's thread; on its own cache line so
+    // workers do not false-share
+    struct alignas(64) Counters {
+        StatCounter packetsReceived;
+        StatCounter bytesReceived;
+        StatCounter packetsRejected;
+    } counters;
+
+    // Recorded by this worker's streams; read lock-free by snapshots
+    alignas(64) Histogram jitterHistogram;
+    Histogram playoutLatencyHistogram;
+
+    // Guards the stream table's structure and retiredStats against snapshot
+    // readers. Taken only when streams are added or evicted, never per packet.
+    mutable std::mutex tableMutex;
+    StreamCounters retiredStats;         // Totals of evicted streams
+};
+
 UDPAudioStreamer::UDPAudioStreamer(int port, int sampleRate, const std::string& saveFile)
     : port_(port), sampleRate_(sampleRate), saveFile_(saveFile) {
     
     audioPlayer_ = std::make_unique<AudioPlayer>(sampleRate, saveFile);
-    packetParser_ = std::make_unique<PacketParser>();
 }
 
 UDPAudioStreamer::~UDPAudioStreamer() {
     stop();
 }
 
+void UDPAudioStreamer::setJitterBufferConfig(const JitterBuffer::Config& config) {
+    if (running_.load()) {
+        std::cerr << "Cannot change jitter buffer configuration while running" << std::endl;
+        return;
+    }
+    jitterConfig_ = config;
+}
+
+void UDPAudioStreamer::setAudioOutput(const AudioOutputConfig& config) {
+    if (running_.load()) {
+        std::cerr << "Cannot change audio output while running" << std::endl;
+        return;
+    }
+    audioPlayer_->setOutputConfig(config);
+}
+
+void UDPAudioStreamer::setDriftCompensation(bool enabled) {
+    if (running_.load()) {
+        std::cerr << "Cannot change drift compensation while running" << std::endl;
+        return;
+    }
+    driftCompensation_ = enabled;
+    audioPlayer_->setDriftCompensation(enabled);
+}
+
+void UDPAudioStreamer::setGainDb(double db) {
+    if (running_.load()) {
+        std::cerr << "Cannot change gain while running" << std::endl;
+        return;
+    }
+    audioPlayer_->setGainDb(db);
+}
+
+void UDPAudioStreamer::setMixing(bool enabled, AudioMixer::Summation summation) {
+    if (running_.load()) {
+        std::cerr << "Cannot change mixing while running" << std::endl;
+        return;
+    }
+    mixing_ = enabled;
+    summation_ = summation;
+}
+
+void UDPAudioStreamer::setStreamGain(const std::string& source, double db) {
+    if (running_.load()) {
+        std::cerr << "Cannot change stream gain while running" << std::endl;
+        return;
+    }
+    streamGains_[source] = static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
 bool UDPAudioStreamer::start() {
     if (running_.load()) {
         std::cerr << "Streamer is already running" << std::endl;
@@ -41,21 +151,104 @@ bool UDPAudioStreamer::start() {
         return false;
     }
 
-    // Initialize UDP socket
-    if (!initializeSocket()) {
-        std::cerr << "Failed to initialize UDP socket" << std::endl;
-        audioPlayer_->shutdown();
-        return false;
+#ifndef __linux__
+    if (workerCount_ > 1) {
+        std::cerr << "Warning: sharded receive workers require Linux SO_REUSEPORT, using one" << std::endl;
+        workerCount_ = 1;
     }
+#endif
+
+    workers_.clear();
+
+    // Every buffered packet lives in a preallocated buffer from here on
+    double heldMs = jitterConfig_.targetDelayMs + jitterConfig_.reorderWindowMs;
+    if (adaptiveDelay_) {
+        heldMs = std::max(jitterConfig_.targetDelayMs, PlayoutDelayController::Config().maxDelayMs) +
+                 jitterConfig_.reorderWindowMs;
+    }
+    packetsPerStream_ = static_cast<size_t>(std::ceil(heldMs / NOMINAL_PACKET_MS)) + 1;
+    streamCount_.store(0);
+    packetPool_ = std::make_unique<PacketBufferPool>((MAX_DATAGRAM_SIZE - 6) / sizeof(int16_t),
+                                                     PACKET_POOL_BUFFERS, MAX_STREAMS * packetsPerStream_);
+    primaryStream_.store(NO_STREAM);
+    jitterConfig_.trackSenderClock = driftCompensation_;
+    mixer_.reset();
+    if (mixing_) {
+        mixer_ = std::make_unique<AudioMixer>(sampleRate_, summation_);
+    }
+
+    for (size_t i = 0; i < workerCount_; ++i) {
+        auto worker = std::make_unique<ReceiveWorker>();
+        worker->index = i;
+        worker->lastEviction = JitterBuffer::Clock::now();
+        workers_.push_back(std::move(worker));
+
+        // Initialize UDP socket
+        if (!initializeSocket(*workers_.back())) {
+            std::cerr << "Failed to initialize UDP socket" << std::endl;
+            cleanup();
+            audioPlayer_->shutdown();
+            return false;
+        }
+
+        // Initialize the receiver's event loop (epoll on Linux)
+        if (!initializeEventLoop(*workers_.back())) {
+            std::cerr << "Failed to initialize receiver event loop" << std::endl;
+            cleanup();
+            audioPlayer_->shutdown();
+            return false;
+        }
+
+        // Preallocate receive buffers for the configured batch size
+        workers_.back()->receiver = std::make_unique<DatagramReceiver>(receiveBatchSize_, MAX_DATAGRAM_SIZE);
+    }
+
+    if (receiveBatchSize_ > 1 && workers_[0]->receiver->batchSize() == 1) {
+        std::cerr << "Warning: batched receive is not supported on this platform" << std::endl;
+    }
+
+#ifdef __linux__
+    // All sockets are in the reuseport group now; steer by source address
+    if (workerCount_ > 1 && steerBySource_ && !attachSteeringProgram()) {
+        std::cerr << "Warning: source address steering unavailable, using kernel flow hash" << std::endl;
+    }
+#endif
 
     running_.store(true);
 
-    // Start UDP receiver thread
-    udpThread_ = std::thread(&UDPAudioStreamer::udpReceiverThread, this);
+    // Start UDP receiver threads
+    for (auto& worker : workers_) {
+        worker->thread = std::thread(&UDPAudioStreamer::udpReceiverThread, this, std::ref(*worker));
+    }
+
+    // Scrapes read lock-free snapshots on the server's own thread
+    if (metricsPort_ > 0) {
+        metricsServer_ = std::make_unique<MetricsServer>([this] { return formatMetrics(); });
+        if (metricsServer_->start(metricsPort_)) {
+            std::cout << "Metrics: http://127.0.0.1:" << metricsPort_ << "/metrics" << std::endl;
+        } else {
+            std::cerr << "Warning: metrics endpoint unavailable on port " << metricsPort_ << std::endl;
+            metricsServer_.reset();
+        }
+    }
 
     std::cout << "UDP Audio Streamer started on port " << port_ << std::endl;
     std::cout << "Sample rate: " << sampleRate_ << " Hz" << std::endl;
     std::cout << "Frame format: [2-byte seq#][4-byte sample timestamp][audio samples]" << std::endl;
+    if (workers_.size() > 1) {
+        std::cout << "Receive workers: " << workers_.size() << " (SO_REUSEPORT"
+                  << (steerBySource_ ? ", steered by source address" : "") << ")" << std::endl;
+    }
+    if (workers_[0]->receiver->batchSize() > 1) {
+        std::cout << "Receive batch size: " << workers_[0]->receiver->batchSize() << " datagrams (recvmmsg)" << std::endl;
+    }
+    std::cout << "Playout delay: " << jitterConfig_.targetDelayMs << " ms"
+              << (adaptiveDelay_ ? " (adaptive)" : "") << std::endl;
+    if (mixer_) {
+        std::cout << "Mixing all senders ("
+                  << (summation_ == AudioMixer::Summation::SoftClip ? "soft clip" : "saturating") << ", "
+                  << simdKernelName(mixer_->kernel()) << ")" << std::endl;
+    }
     if (!saveFile_.empty()) {
         std::cout << "Saving audio to: " << saveFile_ << std::endl;
     }
@@ -68,23 +261,66 @@ void UDPAudioStreamer::stop() {
 
     running_.store(false);
 
-    // Wait for UDP thread to finish
-    if (udpThread_.joinable()) {
-        udpThread_.join();
+    // No scrapes while the pipeline is torn down
+    if (metricsServer_) {
+        metricsServer_->stop();
+        metricsServer_.reset();
+    }
+
+#ifdef __linux__
+    // Wake the receivers out of epoll_wait immediately
+    for (auto& worker : workers_) {
+        uint64_t one = 1;
+        if (write(worker->wakeFd, &one, sizeof(one)) < 0) {
+            perror("Failed to wake receiver thread");
+        }
+    }
+#endif
+
+    // Wait for UDP threads to finish
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
     }
 
     // Print statistics
-    auto parserStats = packetParser_->getStats();
-    if (parserStats.totalReceived > 0) {
+    Statistics stats = getStatistics();
+    if (stats.packetsReceived > 0) {
         std::cout << "\nPacket Statistics:" << std::endl;
-        std::cout << "  Packets received: " << parserStats.totalReceived << std::endl;
-        std::cout << "  Packets dropped: " << parserStats.totalDropped << std::endl;
-        std::cout << "  Packets out of order: " << parserStats.outOfOrder << std::endl;
+        std::cout << "  Packets received: " << stats.packetsReceived << std::endl;
+        std::cout << "  Packets dropped: " << stats.packetsDropped << std::endl;
+        std::cout << "  Packets out of order: " << stats.packetsOutOfOrder << std::endl;
         
-        uint64_t totalPackets = parserStats.totalReceived + parserStats.totalDropped;
-        if (totalPackets > 0) {
-            double dropRate = (static_cast<double>(parserStats.totalDropped) / totalPackets) * 100.0;
-            std::cout << "  Drop rate: " << std::fixed << std::setprecision(2) << dropRate << "%" << std::endl;
+        std::cout << "  Drop rate: " << std::fixed << std::setprecision(2) << stats.dropRate * 100.0 << "%" << std::endl;
+
+        std::cout << "  Late packets discarded: " << stats.packetsLate << std::endl;
+        std::cout << "  Duplicate packets discarded: " << stats.packetsDuplicate << std::endl;
+        std::cout << "  Samples concealed: " << stats.samplesConcealed << std::endl;
+        std::cout << "  Interarrival jitter: " << stats.jitterMs << " ms" << std::endl;
+        std::cout << "  Playout delay: " << stats.targetDelayMs << " ms" << std::endl;
+        std::cout << "  Playback underruns: " << stats.bufferUnderruns << std::endl;
+        std::cout << "  Samples dropped on overflow: " << stats.samplesOverflowed << std::endl;
+        std::cout << "  Clock drift: " << stats.clockDriftPpm << " ppm" << std::endl;
+        if (mixer_) {
+            std::cout << "  Samples late to the mix: " << stats.samplesMixedLate << std::endl;
+            std::cout << "  Mix realignments: " << stats.mixRealigns << std::endl;
+        }
+
+        std::vector<StreamStatistics> streams = getStreamStatistics();
+        if (streams.size() > 1) {
+            std::cout << "  Active streams: " << streams.size() << std::endl;
+            for (const auto& stream : streams) {
+                std::cout << "    " << stream.source << ": " << stream.packetsReceived << " received, "
+                          << stream.packetsDropped << " dropped, jitter " << stream.jitterMs << " ms" << std::endl;
+            }
+        }
+
+        std::cout << formatHistograms(getHistograms(), false);
+
+        if (packetPool_->getFallbackAllocations() > 0) {
+            std::cout << "  Packet buffer pool exhausted: " << packetPool_->getFallbackAllocations()
+                      << " heap allocations" << std::endl;
         }
     }
 
@@ -95,7 +331,7 @@ void UDPAudioStreamer::stop() {
     std::cout << "UDP Audio Streamer stopped" << std::endl;
 }
 
-bool UDPAudioStreamer::initializeSocket() {
+bool UDPAudioStreamer::initializeSocket(ReceiveWorker& worker) {
 #ifdef _WIN32
     // Initialize Winsock
     WSADATA wsaData;
@@ -132,13 +368,14 @@ bool UDPAudioStreamer::initializeSocket() {
         return false;
     }
 
-    // Set socket timeout
-    DWORD timeout = 1000; // 1 second
+    // Set socket timeout short enough that the jitter buffer releases held
+    // audio on time even when no packets arrive
+    DWORD timeout = RECEIVE_TIMEOUT_MS;
     if (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout)) == SOCKET_ERROR) {
         std::cerr << "Failed to set socket timeout: " << WSAGetLastError() << std::endl;
     }
 
-    socket_ = sock;
+    worker.socket = sock;
 
 #else
     // Unix/Linux socket implementation
@@ -154,6 +391,16 @@ bool UDPAudioStreamer::initializeSocket() {
         perror("setsockopt(SO_REUSEADDR) failed");
     }
 
+#ifdef __linux__
+    // Sharded workers each bind their own socket to the same port and the
+    // kernel spreads incoming datagrams across them
+    if (workerCount_ > 1 && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+        perror("setsockopt(SO_REUSEPORT) failed");
+        close(sock);
+        return false;
+    }
+#endif
+
     // Bind socket
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
@@ -166,87 +413,618 @@ bool UDPAudioStreamer::initializeSocket() {
         return false;
     }
 
-    // Set socket timeout
+    // Kernel receive timestamps for accurate jitter and latency measurement
+    if (!DatagramReceiver::enableKernelTimestamps(sock)) {
+#ifdef __linux__
+        perror("setsockopt(SO_TIMESTAMPNS) failed");
+#endif
+    }
+
+#ifdef __linux__
+    // The epoll loop drains the socket until it would block
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags < 0 || fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("Failed to make socket non-blocking");
+        close(sock);
+        return false;
+    }
+#else
+    // Set socket timeout short enough that the jitter buffer releases held
+    // audio on time even when no packets arrive
     struct timeval timeout;
-    timeout.tv_sec = 1;
-    timeout.tv_usec = 0;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = RECEIVE_TIMEOUT_MS * 1000;
     if (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
         perror("Failed to set socket timeout");
     }
+#endif
 
-    socket_ = sock;
+    worker.socket = sock;
 #endif
 
     return true;
 }
 
-void UDPAudioStreamer::udpReceiverThread() {
-    const size_t BUFFER_SIZE = 4096;
-    uint8_t buffer[BUFFER_SIZE];
+bool UDPAudioStreamer::initializeEventLoop(ReceiveWorker& worker) {
+#ifdef __linux__
+    worker.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    worker.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    worker.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (worker.epollFd < 0 || worker.wakeFd < 0 || worker.timerFd < 0) {
+        perror("Failed to create epoll/eventfd/timerfd");
+        return false;
+    }
 
+    for (int fd : {worker.socket, worker.wakeFd, worker.timerFd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            perror("epoll_ctl failed");
+            return false;
+        }
+    }
+#else
+    (void)worker;
+#endif
+    return true;
+}
+
+#ifdef __linux__
+bool UDPAudioStreamer::attachSteeringProgram() {
+    // Classic BPF run by the reuseport group: hash the IPv4 source address
+    // and UDP source port (assuming no IP options) and return a socket index,
+    // so every sender is always handled by the same worker
+    uint32_t workers = static_cast<uint32_t>(workers_.size());
+    sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 12)),  // A = saddr
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),                                              // X = A
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 20)),  // A = sport
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),                                       // A ^= X
+        BPF_STMT(BPF_ALU | BPF_MUL | BPF_K, 0x9E3779B1u),                             // A *= golden ratio
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 16),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, workers),                                 // A %= workers
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    sock_fprog program{static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+
+    if (setsockopt(workers_[0]->socket, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                   &program, sizeof(program)) < 0) {
+        perror("setsockopt(SO_ATTACH_REUSEPORT_CBPF) failed");
+        return false;
+    }
+    return true;
+}
+
+void UDPAudioStreamer::pinToCore(size_t index) {
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) return;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index % cores, &cpus);
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (result != 0) {
+        std::cerr << "Warning: failed to pin receive worker " << index << ": " << std::strerror(result) << std::endl;
+    }
+}
+#endif
+
+void UDPAudioStreamer::udpReceiverThread(ReceiveWorker& worker) {
+#ifdef __linux__
+    if (workers_.size() > 1) {
+        pinToCore(worker.index);
+    }
+
+    epoll_event events[3];
+    std::optional<JitterBuffer::Clock::time_point> nextRelease;
+
+    while (running_.load()) {
+        // Wake up exactly when a jitter buffer next has audio to release
+        armReleaseTimer(worker, nextRelease);
+
+        int ready = epoll_wait(worker.epollFd, events, 3, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == worker.socket) {
+                // Drain what is queued, bounded so release timing is not starved
+                for (int n = 0; n < MAX_RECEIVES_PER_WAKE && receiveDatagrams(worker) > 0; ++n) {
+                }
+            } else {
+                // Wakeup or timer expiry: just consume the counter
+                uint64_t counter;
+                if (read(fd, &counter, sizeof(counter)) < 0 && errno != EAGAIN) {
+                    perror("Failed to read event counter");
+                }
+            }
+        }
+
+        if (running_.load()) {
+            nextRelease = servicePlayout(worker, JitterBuffer::Clock::now());
+        }
+    }
+#else
     while (running_.load()) {
+        receiveDatagrams(worker);
+        servicePlayout(worker, JitterBuffer::Clock::now());
+    }
+#endif
+}
+
+int UDPAudioStreamer::receiveDatagrams(ReceiveWorker& worker) {
+    DatagramReceiver& receiver = *worker.receiver;
+
+    int count = receiver.receive(worker.socket);
+    if (count < 0) {
+        if (running_.load()) {
 #ifdef _WIN32
-        sockaddr_in clientAddr;
-        int clientAddrLen = sizeof(clientAddr);
-        int bytesReceived = recvfrom(static_cast<SOCKET>(socket_), 
-                                   reinterpret_cast<char*>(buffer), 
-                                   BUFFER_SIZE, 0,
-                                   (sockaddr*)&clientAddr, &clientAddrLen);
-
-        if (bytesReceived == SOCKET_ERROR) {
-            int error = WSAGetLastError();
-            if (error == WSAETIMEDOUT) {
-                continue; // Timeout, check running flag again
+            std::cerr << "UDP receive error: " << WSAGetLastError() << std::endl;
+#else
+            perror("UDP receive error");
+#endif
+        }
+        return 0;
+    }
+
+    if (running_.load()) {
+        for (int i = 0; i < count; ++i) {
+            handleDatagram(worker, receiver[i]);
+        }
+    }
+    return count;
+}
+
+std::optional<JitterBuffer::Clock::time_point> UDPAudioStreamer::servicePlayout(ReceiveWorker& worker,
+                                                                               JitterBuffer::Clock::time_point now) {
+    std::optional<JitterBuffer::Clock::time_point> nextRelease;
+
+    worker.streams.forEach([&](const uint64_t& key, std::unique_ptr<AudioStream>& stream) {
+        // Track the measured jitter with the playout delay
+        if (stream->delayController &&
+            stream->delayController->update(stream->parser.getJitterMs(),
+                                            stream->jitterBuffer.getStats().packetsLate, now)) {
+            stream->jitterBuffer.setTargetDelay(stream->delayController->getTargetDelayMs());
+        }
+
+        const int16_t* samples;
+        if (mixer_) {
+            // Every stream lands in the mix at the instant it was due
+            JitterBuffer::Clock::time_point chunkTime;
+            while (size_t count = stream->jitterBuffer.releaseChunk(now, samples, chunkTime)) {
+                mixer_->add(stream->mixInput, samples, count, chunkTime);
             }
-            if (running_.load()) {
-                std::cerr << "UDP receive error: " << error << std::endl;
+        } else {
+            // Copy audio whose playout time has come straight from the jitter
+            // buffer into the player; other streams are still drained so their
+            // buffers stay bounded
+            bool primary = primaryStream_.load(std::memory_order_acquire) == key;
+            while (size_t count = stream->jitterBuffer.releaseChunk(now, samples)) {
+                if (primary) {
+                    audioPlayer_->addAudioData(samples, count);
+                }
             }
-            continue;
         }
-#else
-        sockaddr_in clientAddr;
-        socklen_t clientAddrLen = sizeof(clientAddr);
-        ssize_t bytesReceived = recvfrom(socket_, buffer, BUFFER_SIZE, 0,
-                                       (struct sockaddr*)&clientAddr, &clientAddrLen);
-
-        if (bytesReceived < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                continue; // Timeout, check running flag again
+
+        auto deadline = stream->jitterBuffer.nextReleaseTime();
+        if (deadline.has_value() && (!nextRelease.has_value() || *deadline < *nextRelease)) {
+            nextRelease = deadline;
+        }
+    });
+
+    if (mixer_) {
+        // Play what every worker has had the hold time to add
+        mixer_->flush(now, &UDPAudioStreamer::deliverMix, this);
+        JitterBuffer::Clock::time_point flushTime;
+        if (mixer_->nextFlushTime(flushTime) && (!nextRelease.has_value() || flushTime < *nextRelease)) {
+            nextRelease = flushTime;
+        }
+    }
+
+    if (now - worker.lastEviction >= std::chrono::seconds(1)) {
+        evictIdleStreams(worker, now);
+        worker.lastEviction = now;
+    }
+
+    return nextRelease;
+}
+
+void UDPAudioStreamer::evictIdleStreams(ReceiveWorker& worker, JitterBuffer::Clock::time_point now) {
+    bool primaryEvicted = false;
+    {
+        std::lock_guard<std::mutex> lock(worker.tableMutex);
+        worker.streams.eraseIf([&](const uint64_t& key, std::unique_ptr<AudioStream>& stream) {
+            if (now - stream->lastActivity < std::chrono::seconds(STREAM_IDLE_TIMEOUT_S)) {
+                return false;
+            }
+
+            // Keep the evicted stream's counters in the totals
+            stream->publishStatistics();
+            StreamStatistics s = stream->getStatistics();
+            StreamCounters& retired = worker.retiredStats;
+            retired.packetsReceived += s.packetsReceived;
+            retired.packetsDropped += s.packetsDropped;
+            retired.packetsOutOfOrder += s.packetsOutOfOrder;
+            retired.packetsLate += s.packetsLate;
+            retired.packetsDuplicate += s.packetsDuplicate;
+            retired.bytesReceived += s.bytesReceived;
+            retired.samplesConcealed += s.samplesConcealed;
+
+            logStream(Logger::Event::StreamRemoved, key);
+            streamCount_.fetch_sub(1, std::memory_order_relaxed);
+
+            uint64_t expected = key;
+            if (primaryStream_.compare_exchange_strong(expected, NO_STREAM, std::memory_order_acq_rel)) {
+                primaryEvicted = true;
             }
-            if (running_.load()) {
-                perror("UDP receive error");
+            return true;
+        });
+    }
+
+    if (primaryEvicted) {
+        promotePrimaryStream(worker);
+    }
+}
+
+void UDPAudioStreamer::logStream(Logger::Event event, uint64_t key) {
+    // The key packs the host-order address above the port
+    Logger::instance().log(event, static_cast<int64_t>(key >> 16), static_cast<int64_t>(key & 0xffff));
+}
+
+void UDPAudioStreamer::promotePrimaryStream(ReceiveWorker& worker) {
+    // Prefer a stream of this worker, then any other; one table lock at a
+    // time so two workers evicting at once cannot deadlock. A sender heard
+    // for the first time in the meantime may already have claimed the slot.
+    auto promoteFrom = [&](ReceiveWorker& candidate) {
+        std::lock_guard<std::mutex> lock(candidate.tableMutex);
+        bool settled = false;
+        candidate.streams.forEach([&](const uint64_t& key, const std::unique_ptr<AudioStream>&) {
+            if (settled) return;
+            settled = true;
+            uint64_t expected = NO_STREAM;
+            if (primaryStream_.compare_exchange_strong(expected, key, std::memory_order_acq_rel) && !mixer_) {
+                logStream(Logger::Event::StreamPlaying, key);
             }
-            continue;
+        });
+        return settled;
+    };
+
+    if (promoteFrom(worker)) return;
+    for (auto& other : workers_) {
+        if (other.get() != &worker && promoteFrom(*other)) return;
+    }
+}
+
+AudioStream* UDPAudioStreamer::findOrCreateStream(ReceiveWorker& worker, const sockaddr_in& source,
+                                                  JitterBuffer::Clock::time_point now) {
+    uint64_t key = AudioStream::makeKey(source);
+    if (auto* existing = worker.streams.find(key)) {
+        return existing->get();
+    }
+
+    AudioStream* created = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(worker.tableMutex);
+        if (worker.streams.size() >= MAX_STREAMS / workers_.size()) {
+            worker.counters.packetsRejected.add();
+            return nullptr;
         }
+
+        auto& stream = *worker.streams.findOrInsert(key).first;
+        stream = std::make_unique<AudioStream>(source, sampleRate_, jitterConfig_, adaptiveDelay_,
+                                               packetPool_.get());
+        stream->lastActivity = now;
+        stream->parser.setJitterHistogram(&worker.jitterHistogram);
+        stream->jitterBuffer.setLatencyHistogram(&worker.playoutLatencyHistogram);
+        auto gain = streamGains_.find(stream->name);
+        if (gain != streamGains_.end()) {
+            stream->mixInput.gain = gain->second;
+        }
+
+        logStream(Logger::Event::StreamAdded, key);
+
+        // The first sender heard becomes the one that is played. Only the worker
+        // owning it writes to the player, keeping its queue single-producer.
+        // When mixing it only supplies the jitter and delay figures.
+        uint64_t expected = NO_STREAM;
+        if (primaryStream_.compare_exchange_strong(expected, key, std::memory_order_acq_rel) && !mixer_) {
+            logStream(Logger::Event::StreamPlaying, key);
+        }
+        created = stream.get();
+    }
+
+    // Set aside pool buffers for the new stream before its first packet, so
+    // the pool only grows when a sender is admitted
+    size_t streams = streamCount_.fetch_add(1, std::memory_order_relaxed) + 1;
+    packetPool_->reserve(streams * packetsPerStream_);
+    return created;
+}
+
+#ifdef __linux__
+void UDPAudioStreamer::armReleaseTimer(ReceiveWorker& worker,
+                                       std::optional<JitterBuffer::Clock::time_point> deadline) {
+    // steady_clock is CLOCK_MONOTONIC on Linux, so its epoch matches the timerfd's
+    itimerspec spec{};
+    if (deadline.has_value()) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline->time_since_epoch()).count();
+        if (ns <= 0) ns = 1;  // A zero it_value would disarm the timer
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000LL);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000LL);
+    }
+    if (timerfd_settime(worker.timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        perror("timerfd_settime failed");
+    }
+}
 #endif
 
-        if (bytesReceived > 0 && running_.load()) {
-            // Parse the packet
-            auto packet = packetParser_->parsePacket(buffer, static_cast<size_t>(bytesReceived));
-            if (packet.has_value()) {
-                // Add audio data to player
-                audioPlayer_->addAudioData(packet->audioSamples);
+void UDPAudioStreamer::handleDatagram(ReceiveWorker& worker, const DatagramReceiver::Datagram& datagram) {
+    // Only a well-formed frame may claim a stream table entry, so junk from
+    // many sources cannot fill the table
+    if (!PacketParser::isWellFormed(datagram.data, datagram.length)) return;
 
-                // Update statistics
-                std::lock_guard<std::mutex> lock(statsMutex_);
-                stats_.packetsReceived++;
-                stats_.bytesReceived += bytesReceived;
-            }
+    AudioStream* stream = findOrCreateStream(worker, datagram.source, datagram.arrival);
+    if (stream == nullptr) return;
+
+    // Parse the packet in place and copy its samples once, from the receive
+    // buffer into the sender's jitter buffer, using the kernel receive time so
+    // scheduling delay in this thread does not look like jitter
+    auto packet = stream->parser.parseView(datagram.data, datagram.length, datagram.arrival);
+    if (packet.has_value()) {
+        stream->jitterBuffer.insert(*packet, datagram.arrival);
+        stream->lastActivity = datagram.arrival;
+        stream->bytesReceived += datagram.length;
+
+        // Update statistics without locking
+        worker.counters.packetsReceived.add();
+        worker.counters.bytesReceived.add(datagram.length);
+        stream->publishStatistics();
+    }
+}
+
+std::vector<UDPAudioStreamer::StreamSnapshot> UDPAudioStreamer::snapshotStreams(StreamCounters& retired) const {
+    std::vector<StreamSnapshot> snapshots;
+
+    for (const auto& worker : workers_) {
+        // Reserve outside the lock so the copy below does not allocate
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(worker->tableMutex);
+            count = worker->streams.size();
+        }
+        snapshots.reserve(snapshots.size() + count + 16);
+
+        std::lock_guard<std::mutex> lock(worker->tableMutex);
+        const StreamCounters& evicted = worker->retiredStats;
+        retired.packetsDropped += evicted.packetsDropped;
+        retired.packetsOutOfOrder += evicted.packetsOutOfOrder;
+        retired.packetsLate += evicted.packetsLate;
+        retired.packetsDuplicate += evicted.packetsDuplicate;
+        retired.samplesConcealed += evicted.samplesConcealed;
+        worker->streams.forEach([&](const uint64_t& key, const std::unique_ptr<AudioStream>& stream) {
+            snapshots.push_back({key, stream->counters.load()});
+        });
+    }
+    return snapshots;
+}
+
+UDPAudioStreamer::Statistics UDPAudioStreamer::getStatistics() const {
+    Statistics stats;
+    uint64_t primary = primaryStream_.load(std::memory_order_acquire);
+
+    for (const auto& worker : workers_) {
+        stats.packetsReceived += worker->counters.packetsReceived.load();
+        stats.bytesReceived += worker->counters.bytesReceived.load();
+        stats.packetsRejected += worker->counters.packetsRejected.load();
+    }
+
+    StreamCounters retired;
+    std::vector<StreamSnapshot> streams = snapshotStreams(retired);
+    stats.packetsDropped = retired.packetsDropped;
+    stats.packetsOutOfOrder = retired.packetsOutOfOrder;
+    stats.packetsLate = retired.packetsLate;
+    stats.packetsDuplicate = retired.packetsDuplicate;
+    stats.samplesConcealed = retired.samplesConcealed;
+    stats.activeStreams = streams.size();
+
+    for (const StreamSnapshot& stream : streams) {
+        const StreamCounters& s = stream.counters;
+        stats.packetsDropped += s.packetsDropped;
+        stats.packetsOutOfOrder += s.packetsOutOfOrder;
+        stats.packetsLate += s.packetsLate;
+        stats.packetsDuplicate += s.packetsDuplicate;
+        stats.samplesConcealed += s.samplesConcealed;
+        if (stream.key == primary) {
+            stats.jitterMs = s.jitterMs;
+            stats.targetDelayMs = s.targetDelayMs;
         }
     }
+
+    uint64_t totalPackets = stats.packetsReceived + stats.packetsDropped;
+    if (totalPackets > 0) {
+        stats.dropRate = static_cast<double>(stats.packetsDropped) / totalPackets;
+    }
+
+    AudioPlayer::Statistics player = audioPlayer_->getStatistics();
+    stats.bufferUnderruns = player.underruns;
+    stats.samplesOverflowed = player.samplesOverflowed;
+    stats.queuedSamples = player.queuedSamples;
+    stats.clockDriftPpm = player.clockDriftPpm;
+
+    if (mixer_) {
+        AudioMixer::Stats mix = mixer_->getStats();
+        stats.samplesMixedLate = mix.samplesLate;
+        stats.mixRealigns = mix.realigns;
+    }
+
+    return stats;
+}
+
+std::vector<StreamStatistics> UDPAudioStreamer::getStreamStatistics() const {
+    StreamCounters retired;
+    std::vector<StreamSnapshot> streams = snapshotStreams(retired);
+
+    std::vector<StreamStatistics> result(streams.size());
+    for (size_t i = 0; i < streams.size(); ++i) {
+        static_cast<StreamCounters&>(result[i]) = streams[i].counters;
+        result[i].source = AudioStream::formatAddress(AudioStream::addressFromKey(streams[i].key));
+    }
+    return result;
+}
+
+UDPAudioStreamer::Histograms UDPAudioStreamer::getHistograms() const {
+    Histograms histograms;
+    for (const auto& worker : workers_) {
+        histograms.jitter.merge(worker->jitterHistogram.snapshot());
+        histograms.playoutLatency.merge(worker->playoutLatencyHistogram.snapshot());
+    }
+    histograms.callbackDuration = audioPlayer_->getCallbackDurationHistogram();
+    histograms.queueDepth = audioPlayer_->getQueueDepthHistogram();
+    return histograms;
+}
+
+std::string UDPAudioStreamer::formatHistograms(const Histograms& histograms, bool json) const {
+    // Queue depth is also shown in ms of audio at the output's sample rate
+    double samplesPerMs = audioPlayer_->getOutputSampleRate() / 1000.0;
+
+    if (json) {
+        return "{\"jitter_ms\":" + formatHistogramJson(histograms.jitter, 1e6) +
+               ",\"playout_latency_ms\":" + formatHistogramJson(histograms.playoutLatency, 1e6) +
+               ",\"callback_duration_us\":" + formatHistogramJson(histograms.callbackDuration, 1e3) +
+               ",\"queue_depth_ms\":" + formatHistogramJson(histograms.queueDepth, samplesPerMs) + "}\n";
+    }
+
+    return "  Jitter |D|:        " + formatHistogramText(histograms.jitter, 1e6, "ms") + "\n" +
+           "  Playout latency:   " + formatHistogramText(histograms.playoutLatency, 1e6, "ms") + "\n" +
+           "  Callback duration: " + formatHistogramText(histograms.callbackDuration, 1e3, "us") + "\n" +
+           "  Queue depth:       " + formatHistogramText(histograms.queueDepth, samplesPerMs, "ms") + "\n";
+}
+
+namespace {
+
+void writeMetric(std::ostream& out, const char* name, const char* type, const char* help, double value) {
+    out << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << ' ' << type << '\n'
+        << name << ' ' << value << '\n';
+}
+
+// Histograms are exported as summaries: fixed quantiles plus _sum and _count
+void writeSummary(std::ostream& out, const char* name, const char* help,
+                  const Histogram::Snapshot& snapshot, double scale) {
+    out << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << " summary\n";
+    for (double quantile : {0.5, 0.99, 0.999}) {
+        out << name << "{quantile=\"" << quantile << "\"} " << snapshot.percentile(quantile) / scale << '\n';
+    }
+    out << name << "_sum " << snapshot.sum / scale << '\n'
+        << name << "_count " << snapshot.count << '\n';
+}
+
+}  // namespace
+
+std::string UDPAudioStreamer::formatMetrics() const {
+    Statistics stats = getStatistics();
+    std::vector<StreamStatistics> streams = getStreamStatistics();
+    Histograms histograms = getHistograms();
+
+    std::ostringstream out;
+    out.precision(9);
+
+    writeMetric(out, "udp_audio_packets_received_total", "counter", "Packets parsed.",
+                static_cast<double>(stats.packetsReceived));
+    writeMetric(out, "udp_audio_packets_dropped_total", "counter", "Packets missing from the sequence.",
+                static_cast<double>(stats.packetsDropped));
+    writeMetric(out, "udp_audio_packets_out_of_order_total", "counter", "Packets received out of sequence.",
+                static_cast<double>(stats.packetsOutOfOrder));
+    writeMetric(out, "udp_audio_packets_late_total", "counter", "Packets arriving after their playout time.",
+                static_cast<double>(stats.packetsLate));
+    writeMetric(out, "udp_audio_packets_duplicate_total", "counter", "Duplicate packets discarded.",
+                static_cast<double>(stats.packetsDuplicate));
+    writeMetric(out, "udp_audio_packets_rejected_total", "counter", "Packets from senders over the stream limit.",
+                static_cast<double>(stats.packetsRejected));
+    writeMetric(out, "udp_audio_bytes_received_total", "counter", "Datagram bytes parsed.",
+                static_cast<double>(stats.bytesReceived));
+    writeMetric(out, "udp_audio_samples_concealed_total", "counter", "Samples synthesized for missing audio.",
+                static_cast<double>(stats.samplesConcealed));
+    writeMetric(out, "udp_audio_playback_underruns_total", "counter", "Audio callbacks that ran out of audio.",
+                static_cast<double>(stats.bufferUnderruns));
+    writeMetric(out, "udp_audio_playback_overflow_samples_total", "counter", "Samples dropped on a full playback queue.",
+                static_cast<double>(stats.samplesOverflowed));
+    writeMetric(out, "udp_audio_playback_queue_samples", "gauge", "Samples queued for playback.",
+                static_cast<double>(stats.queuedSamples));
+    writeMetric(out, "udp_audio_clock_drift_ppm", "gauge", "Sender sample clock against the output device, in ppm.",
+                stats.clockDriftPpm);
+    writeMetric(out, "udp_audio_mix_late_samples_total", "counter", "Samples reaching the mixer after their instant was played.",
+                static_cast<double>(stats.samplesMixedLate));
+    writeMetric(out, "udp_audio_mix_realigns_total", "counter", "Streams re-placed on the mix timeline.",
+                static_cast<double>(stats.mixRealigns));
+    writeMetric(out, "udp_audio_active_streams", "gauge", "Senders with a live pipeline.",
+                static_cast<double>(stats.activeStreams));
+    writeMetric(out, "udp_audio_playout_delay_seconds", "gauge", "Jitter buffer playout delay of the played stream.",
+                stats.targetDelayMs / 1000.0);
+
+    out << "# HELP udp_audio_stream_jitter_seconds RFC 3550 interarrival jitter per sender.\n"
+        << "# TYPE udp_audio_stream_jitter_seconds gauge\n";
+    for (const auto& stream : streams) {
+        out << "udp_audio_stream_jitter_seconds{source=\"" << stream.source << "\"} "
+            << stream.jitterMs / 1000.0 << '\n';
+    }
+    out << "# HELP udp_audio_stream_packets_received_total Packets parsed per sender.\n"
+        << "# TYPE udp_audio_stream_packets_received_total counter\n";
+    for (const auto& stream : streams) {
+        out << "udp_audio_stream_packets_received_total{source=\"" << stream.source << "\"} "
+            << stream.packetsReceived << '\n';
+    }
+    out << "# HELP udp_audio_stream_packets_dropped_total Packets missing per sender.\n"
+        << "# TYPE udp_audio_stream_packets_dropped_total counter\n";
+    for (const auto& stream : streams) {
+        out << "udp_audio_stream_packets_dropped_total{source=\"" << stream.source << "\"} "
+            << stream.packetsDropped << '\n';
+    }
+
+    writeSummary(out, "udp_audio_transit_deviation_seconds", "Per-packet interarrival transit deviation |D|.",
+                 histograms.jitter, 1e9);
+    writeSummary(out, "udp_audio_playout_latency_seconds", "Time from receive to jitter buffer release.",
+                 histograms.playoutLatency, 1e9);
+    writeSummary(out, "udp_audio_callback_duration_seconds", "Audio callback run time.",
+                 histograms.callbackDuration, 1e9);
+    writeSummary(out, "udp_audio_playback_queue_depth_samples", "Playback queue depth at each audio callback.",
+                 histograms.queueDepth, 1.0);
+
+    return out.str();
+}
+
+void UDPAudioStreamer::deliverMix(const float* samples, size_t count, void* userData) {
+    static_cast<UDPAudioStreamer*>(userData)->audioPlayer_->addAudioData(samples, count);
 }
 
 void UDPAudioStreamer::cleanup() {
+    for (auto& worker : workers_) {
 #ifdef _WIN32
-    if (socket_ != 0) {
-        closesocket(static_cast<SOCKET>(socket_));
-        socket_ = 0;
-        WSACleanup();
-    }
+        if (worker->socket != 0) {
+            closesocket(static_cast<SOCKET>(worker->socket));
+            worker->socket = 0;
+            WSACleanup();
+        }
 #else
-    if (socket_ >= 0) {
-        close(socket_);
-        socket_ = -1;
-    }
+        if (worker->socket >= 0) {
+            close(worker->socket);
+            worker->socket = -1;
+        }
 #endif
-}
\ No newline at end of file
+
+#ifdef __linux__
+        for (int* fd : {&worker->epollFd, &worker->wakeFd, &worker->timerFd}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+#endif
+    }
+}
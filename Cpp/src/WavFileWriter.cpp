@@ -0,0 +1,155 @@
+#include "WavFileWriter.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+WavFileWriter::WavFileWriter(int sampleRate, size_t blockSamples, size_t blockCount)
+    : sampleRate_(sampleRate), blockSamples_(blockSamples), blocks_(blockCount),
+      filledBlocks_(blockCount), freeBlocks_(blockCount) {
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        blocks_[i].samples = std::make_unique<int16_t[]>(blockSamples_);
+        uint32_t index = static_cast<uint32_t>(i);
+        freeBlocks_.write(&index, 1);
+    }
+}
+
+WavFileWriter::~WavFileWriter() {
+    close();
+}
+
+bool WavFileWriter::open(const std::string& path) {
+    if (isOpen()) return false;
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open WAV file: " << path << std::endl;
+        return false;
+    }
+
+    writeHeader();
+    samplesWritten_.store(0);
+    samplesDropped_.store(0);
+
+    running_.store(true);
+    writerThread_ = std::thread(&WavFileWriter::writerThread, this);
+    return true;
+}
+
+bool WavFileWriter::write(const int16_t* samples, size_t count) {
+    while (count > 0) {
+        if (currentBlock_ == NO_BLOCK && freeBlocks_.read(&currentBlock_, 1) == 0) {
+            // Every block is waiting for the disk; drop instead of growing
+            currentBlock_ = NO_BLOCK;
+            samplesDropped_.fetch_add(count, std::memory_order_relaxed);
+            return false;
+        }
+
+        Block& block = blocks_[currentBlock_];
+        size_t n = std::min(count, blockSamples_ - block.count);
+        std::memcpy(block.samples.get() + block.count, samples, n * sizeof(int16_t));
+        block.count += n;
+        samples += n;
+        count -= n;
+
+        if (block.count == blockSamples_) {
+            flush();
+        }
+    }
+    return true;
+}
+
+void WavFileWriter::flush() {
+    if (currentBlock_ == NO_BLOCK || blocks_[currentBlock_].count == 0) return;
+
+    // The queue holds every block, so this never fails
+    filledBlocks_.write(&currentBlock_, 1);
+    currentBlock_ = NO_BLOCK;
+}
+
+void WavFileWriter::close() {
+    if (!isOpen()) return;
+
+    flush();
+    running_.store(false);
+    writerThread_.join();
+
+    // The writer has stopped; pick up anything queued after its last pass
+    writeQueuedBlocks();
+    updateHeader();
+    file_.close();
+}
+
+void WavFileWriter::writerThread() {
+    auto lastHeaderUpdate = std::chrono::steady_clock::now();
+
+    while (running_.load()) {
+        if (writeQueuedBlocks() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_INTERVAL_MS));
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastHeaderUpdate >= std::chrono::milliseconds(HEADER_UPDATE_INTERVAL_MS)) {
+            updateHeader();
+            lastHeaderUpdate = now;
+        }
+    }
+}
+
+size_t WavFileWriter::writeQueuedBlocks() {
+    size_t written = 0;
+    uint32_t index;
+    while (filledBlocks_.read(&index, 1) == 1) {
+        Block& block = blocks_[index];
+        file_.write(reinterpret_cast<const char*>(block.samples.get()), block.count * sizeof(int16_t));
+        samplesWritten_.fetch_add(block.count, std::memory_order_relaxed);
+        block.count = 0;
+        freeBlocks_.write(&index, 1);
+        written++;
+    }
+    return written;
+}
+
+void WavFileWriter::writeHeader() {
+    // WAV header structure
+    struct WavHeader {
+        char riff[4] = {'R', 'I', 'F', 'F'};
+        uint32_t fileSize = 36;    // Updated as data is written
+        char wave[4] = {'W', 'A', 'V', 'E'};
+        char fmt[4] = {'f', 'm', 't', ' '};
+        uint32_t fmtSize = 16;
+        uint16_t audioFormat = 1;  // PCM
+        uint16_t numChannels = 1;  // Mono
+        uint32_t sampleRate;
+        uint32_t byteRate;
+        uint16_t blockAlign = 2;   // 16-bit mono
+        uint16_t bitsPerSample = 16;
+        char data[4] = {'d', 'a', 't', 'a'};
+        uint32_t dataSize = 0;     // Updated as data is written
+    } header;
+
+    header.sampleRate = sampleRate_;
+    header.byteRate = sampleRate_ * 2;  // Sample rate * channels * bytes per sample
+
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void WavFileWriter::updateHeader() {
+    // RIFF sizes are 32-bit; past 4 GB the header stays at the maximum
+    uint64_t bytes = samplesWritten_.load(std::memory_order_relaxed) * sizeof(int16_t);
+    uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(bytes, 0xFFFFFFFFu - 36));
+    uint32_t fileSize = dataSize + 36;  // Total file size - 8 bytes
+
+    std::streampos end = file_.tellp();
+
+    // Seek to file size field and update
+    file_.seekp(4);
+    file_.write(reinterpret_cast<const char*>(&fileSize), 4);
+
+    // Seek to data size field and update
+    file_.seekp(40);
+    file_.write(reinterpret_cast<const char*>(&dataSize), 4);
+
+    file_.seekp(end);
+    file_.flush();
+}
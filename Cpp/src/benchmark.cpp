@@ -0,0 +1,790 @@
+#include "DatagramReceiver.h"
+#include "PacketParser.h"
+#include "PacketLossConcealer.h"
+#include "PolyphaseResampler.h"
+#include "AudioMixer.h"
+#include "SampleConversion.h"
+#include "SignalGenerator.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <random>
+#include <memory>
+#include <algorithm>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+double threadCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Parse "--name value" style numeric options; returns false on a bad value
+bool parseOption(int& i, int argc, char* argv[], const std::string& name, double& value) {
+    if (i + 1 >= argc) {
+        std::cerr << "Error: " << name << " requires a value" << std::endl;
+        return false;
+    }
+    try {
+        value = std::stod(argv[++i]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid value for " << name << ": " << argv[i] << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// receive: loopback packets/second per core, recvfrom loop vs recvmmsg batches
+
+struct ReceiveResult {
+    uint64_t packets = 0;
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;
+};
+
+void floodSender(int port, size_t samplesPerPacket, std::atomic<bool>& stop) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("Socket creation failed");
+        return;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("Connect failed");
+        close(sock);
+        return;
+    }
+
+    std::vector<uint8_t> packet(6 + samplesPerPacket * 2, 0);
+    uint16_t sequenceNumber = 0;
+    uint32_t sampleTimestamp = 0;
+
+#ifdef __linux__
+    const size_t BATCH = 32;
+    std::vector<std::vector<uint8_t>> packets(BATCH, packet);
+    std::vector<iovec> iovecs(BATCH);
+    std::vector<mmsghdr> messages(BATCH);
+    while (!stop.load(std::memory_order_relaxed)) {
+        for (size_t i = 0; i < BATCH; ++i) {
+            std::memcpy(packets[i].data(), &sequenceNumber, 2);
+            std::memcpy(packets[i].data() + 2, &sampleTimestamp, 4);
+            sequenceNumber++;
+            sampleTimestamp += static_cast<uint32_t>(samplesPerPacket);
+            iovecs[i] = {packets[i].data(), packets[i].size()};
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        sendmmsg(sock, messages.data(), BATCH, 0);
+    }
+#else
+    while (!stop.load(std::memory_order_relaxed)) {
+        std::memcpy(packet.data(), &sequenceNumber, 2);
+        std::memcpy(packet.data() + 2, &sampleTimestamp, 4);
+        sequenceNumber++;
+        sampleTimestamp += static_cast<uint32_t>(samplesPerPacket);
+        send(sock, packet.data(), packet.size(), 0);
+    }
+#endif
+
+    close(sock);
+}
+
+bool runReceiveMode(size_t batchSize, size_t samplesPerPacket, int senders, double seconds,
+                    ReceiveResult& result) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("Socket creation failed");
+        return false;
+    }
+
+    int rcvbuf = 8 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    timeval timeout{0, 100000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addrLen = sizeof(addr);
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        getsockname(sock, reinterpret_cast<sockaddr*>(&addr), &addrLen) < 0) {
+        perror("Bind failed");
+        close(sock);
+        return false;
+    }
+    int port = ntohs(addr.sin_port);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> senderThreads;
+    for (int i = 0; i < senders; ++i) {
+        senderThreads.emplace_back(floodSender, port, samplesPerPacket, std::ref(stop));
+    }
+
+    DatagramReceiver receiver(batchSize);
+    PacketParser parser;
+    uint64_t packets = 0;
+
+    // Let the senders fill the socket buffer before measuring
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(seconds));
+    double cpuStart = threadCpuSeconds();
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        int count = receiver.receive(sock);
+        for (int i = 0; i < count; ++i) {
+            if (parser.parseView(receiver[i].data, receiver[i].length, receiver[i].arrival).has_value()) {
+                packets++;
+            }
+        }
+    }
+
+    double cpuEnd = threadCpuSeconds();
+    auto end = std::chrono::steady_clock::now();
+
+    stop.store(true);
+    for (auto& t : senderThreads) {
+        t.join();
+    }
+    close(sock);
+
+    result.packets = packets;
+    result.wallSeconds = std::chrono::duration<double>(end - start).count();
+    result.cpuSeconds = cpuEnd - cpuStart;
+    return true;
+}
+
+void printReceiveResult(const std::string& label, const ReceiveResult& result) {
+    double perCore = result.cpuSeconds > 0 ? result.packets / result.cpuSeconds : 0.0;
+    std::cout << "  " << std::left << std::setw(18) << label << std::right
+              << std::setw(12) << result.packets << " packets  "
+              << std::setw(12) << static_cast<uint64_t>(result.packets / result.wallSeconds) << " pkt/s  "
+              << std::setw(12) << static_cast<uint64_t>(perCore) << " pkt/s per core" << std::endl;
+}
+
+int runReceiveBenchmark(int argc, char* argv[]) {
+    double batch = 32;
+    double samples = 80;
+    double senders = 2;
+    double seconds = 3.0;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--batch") {
+            ok = parseOption(i, argc, argv, arg, batch);
+        } else if (arg == "--samples") {
+            ok = parseOption(i, argc, argv, arg, samples);
+        } else if (arg == "--senders") {
+            ok = parseOption(i, argc, argv, arg, senders);
+        } else if (arg == "--seconds") {
+            ok = parseOption(i, argc, argv, arg, seconds);
+        } else {
+            std::cerr << "Error: Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+        if (!ok) return 1;
+    }
+
+    if (batch < 1 || samples < 1 || senders < 1 || seconds <= 0) {
+        std::cerr << "Error: Options must be positive" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Receive benchmark: " << static_cast<int>(samples) << " samples/packet, "
+              << static_cast<int>(senders) << " loopback sender thread(s), "
+              << seconds << " s per mode" << std::endl;
+
+    ReceiveResult single;
+    ReceiveResult batched;
+    if (!runReceiveMode(1, static_cast<size_t>(samples), static_cast<int>(senders), seconds, single)) {
+        return 1;
+    }
+    printReceiveResult("1 per syscall", single);
+
+    if (!DatagramReceiver::batchingSupported()) {
+        std::cout << "  recvmmsg not supported on this platform" << std::endl;
+        return 0;
+    }
+    if (!runReceiveMode(static_cast<size_t>(batch), static_cast<size_t>(samples),
+                        static_cast<int>(senders), seconds, batched)) {
+        return 1;
+    }
+    printReceiveResult(std::to_string(static_cast<int>(batch)) + " per syscall", batched);
+
+    if (single.cpuSeconds > 0 && batched.cpuSeconds > 0 && single.packets > 0) {
+        double speedup = (batched.packets / batched.cpuSeconds) / (single.packets / single.cpuSeconds);
+        std::cout << "  Per-core speedup: " << std::fixed << std::setprecision(2) << speedup << "x" << std::endl;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// conceal: objective quality and cost of each loss concealment mode
+
+// Voiced-speech-like test signal: eight harmonics of a 140 Hz fundamental with
+// vibrato and a slow level change, or a plain 440 Hz tone
+std::vector<int16_t> makeTestSignal(const std::string& signal, int sampleRate, double seconds) {
+    std::vector<int16_t> samples(static_cast<size_t>(seconds * sampleRate));
+    const double PI = 3.14159265358979323846;
+    double phase = 0.0;
+    for (size_t n = 0; n < samples.size(); ++n) {
+        double t = static_cast<double>(n) / sampleRate;
+        double value;
+        if (signal == "tone") {
+            value = 10000.0 * std::sin(2.0 * PI * 440.0 * t);
+        } else {
+            phase += 2.0 * PI * (140.0 + 10.0 * std::sin(2.0 * PI * 3.0 * t)) / sampleRate;
+            value = 0.0;
+            for (int k = 1; k <= 8; ++k) {
+                value += std::sin(k * phase) / k;
+            }
+            value *= 5000.0 * (0.75 + 0.25 * std::sin(2.0 * PI * 0.7 * t));
+        }
+        samples[n] = static_cast<int16_t>(value);
+    }
+    return samples;
+}
+
+struct ConcealResult {
+    double concealedSnrDb = 0.0;  // Lost packets and the fade back into real audio
+    double overallSnrDb = 0.0;
+    double boundaryJumpDb = 0.0;  // Slope error at the start and end of each gap
+    double usPerLostPacket = 0.0;
+};
+
+double snrDb(double signal, double noise) {
+    if (noise <= 0.0) return 99.0;
+    return 10.0 * std::log10(signal / noise);
+}
+
+ConcealResult runConcealMode(PacketLossConcealer::Mode mode, const std::vector<int16_t>& reference,
+                             const std::vector<bool>& lost, size_t packetSamples, int sampleRate) {
+    PacketLossConcealer concealer(sampleRate, mode);
+    std::vector<int16_t> output(reference.size());
+    double concealSeconds = 0.0;
+    size_t lostPackets = 0;
+
+    for (size_t p = 0; p < lost.size(); ++p) {
+        int16_t* chunk = output.data() + p * packetSamples;
+        if (lost[p]) {
+            auto start = std::chrono::steady_clock::now();
+            concealer.conceal(chunk, packetSamples);
+            concealSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            lostPackets++;
+        } else {
+            std::memcpy(chunk, reference.data() + p * packetSamples, packetSamples * sizeof(int16_t));
+            concealer.play(chunk, packetSamples);
+        }
+    }
+
+    double concealedSignal = 0.0, concealedNoise = 0.0;
+    double totalSignal = 0.0, totalNoise = 0.0;
+    double slopeSignal = 0.0, jumpNoise = 0.0;
+    size_t mergeSamples = static_cast<size_t>(sampleRate / 100);
+    size_t sinceLoss = mergeSamples;
+
+    for (size_t n = 0; n < output.size(); ++n) {
+        size_t p = n / packetSamples;
+        double error = static_cast<double>(output[n]) - reference[n];
+        double power = static_cast<double>(reference[n]) * reference[n];
+        totalSignal += power;
+        totalNoise += error * error;
+
+        if (lost[p]) sinceLoss = 0;
+        if (sinceLoss < mergeSamples) {
+            concealedSignal += power;
+            concealedNoise += error * error;
+        }
+        sinceLoss++;
+
+        if (n > 0) {
+            double slope = static_cast<double>(reference[n]) - reference[n - 1];
+            slopeSignal += slope * slope;
+            bool boundary = n % packetSamples == 0 && lost[p] != lost[p - 1];
+            if (boundary) {
+                double jump = (static_cast<double>(output[n]) - output[n - 1]) - slope;
+                jumpNoise += jump * jump;
+            }
+        }
+    }
+
+    size_t boundaries = 0;
+    for (size_t p = 1; p < lost.size(); ++p) {
+        if (lost[p] != lost[p - 1]) boundaries++;
+    }
+
+    ConcealResult result;
+    result.concealedSnrDb = snrDb(concealedSignal, concealedNoise);
+    result.overallSnrDb = snrDb(totalSignal, totalNoise);
+    // Mean squared slope error at gap edges relative to the mean squared slope
+    result.boundaryJumpDb = boundaries > 0 && jumpNoise > 0
+        ? 10.0 * std::log10((jumpNoise / boundaries) / (slopeSignal / (output.size() - 1)))
+        : -99.0;
+    result.usPerLostPacket = lostPackets > 0 ? concealSeconds * 1e6 / lostPackets : 0.0;
+    return result;
+}
+
+int runConcealBenchmark(int argc, char* argv[]) {
+    double sampleRate = 16000;
+    double packetMs = 20;
+    double lossRate = 0.05;
+    double seconds = 20;
+    std::string signal = "voice";
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--sample-rate") {
+            ok = parseOption(i, argc, argv, arg, sampleRate);
+        } else if (arg == "--packet-ms") {
+            ok = parseOption(i, argc, argv, arg, packetMs);
+        } else if (arg == "--loss") {
+            ok = parseOption(i, argc, argv, arg, lossRate);
+        } else if (arg == "--seconds") {
+            ok = parseOption(i, argc, argv, arg, seconds);
+        } else if (arg == "--signal" && i + 1 < argc) {
+            signal = argv[++i];
+        } else {
+            std::cerr << "Error: Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+        if (!ok) return 1;
+    }
+
+    size_t packetSamples = static_cast<size_t>(sampleRate * packetMs / 1000.0);
+    if (sampleRate < 8000 || packetSamples == 0 || lossRate < 0 || lossRate >= 1 || seconds <= 0 ||
+        (signal != "voice" && signal != "tone")) {
+        std::cerr << "Error: Invalid options" << std::endl;
+        return 1;
+    }
+
+    int rate = static_cast<int>(sampleRate);
+    std::vector<int16_t> reference = makeTestSignal(signal, rate, seconds);
+    size_t packets = reference.size() / packetSamples;
+    reference.resize(packets * packetSamples);
+
+    // Same loss pattern for every mode; the first 100 ms always arrive
+    std::mt19937 random(12345);
+    std::bernoulli_distribution drop(lossRate);
+    std::vector<bool> lost(packets);
+    size_t lostCount = 0;
+    for (size_t p = 0; p < packets; ++p) {
+        lost[p] = p * packetSamples >= sampleRate / 10 && drop(random);
+        lostCount += lost[p];
+    }
+
+    std::cout << "Concealment benchmark: " << signal << " at " << rate << " Hz, "
+              << packetMs << " ms packets, " << lostCount << " of " << packets << " lost" << std::endl;
+    std::cout << "  " << std::left << std::setw(12) << "mode" << std::right
+              << std::setw(16) << "concealed SNR" << std::setw(14) << "overall SNR"
+              << std::setw(16) << "boundary jump" << std::setw(18) << "us/lost packet" << std::endl;
+
+    const std::pair<const char*, PacketLossConcealer::Mode> modes[] = {
+        {"silence", PacketLossConcealer::Mode::Silence},
+        {"repeat", PacketLossConcealer::Mode::RepeatLast},
+        {"waveform", PacketLossConcealer::Mode::Waveform},
+        {"lpc", PacketLossConcealer::Mode::Lpc},
+    };
+    for (const auto& [name, mode] : modes) {
+        ConcealResult result = runConcealMode(mode, reference, lost, packetSamples, rate);
+        std::cout << "  " << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(13) << result.concealedSnrDb << " dB"
+                  << std::setw(11) << result.overallSnrDb << " dB"
+                  << std::setw(13) << result.boundaryJumpDb << " dB"
+                  << std::setw(18) << result.usPerLostPacket << std::endl;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// resample: polyphase sample-rate conversion throughput per kernel, one core
+
+int runResampleBenchmark(int argc, char* argv[]) {
+    double inputRate = 16000;
+    double outputRate = 48000;
+    double seconds = 2;
+    double block = 320;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--from") {
+            ok = parseOption(i, argc, argv, arg, inputRate);
+        } else if (arg == "--to") {
+            ok = parseOption(i, argc, argv, arg, outputRate);
+        } else if (arg == "--block") {
+            ok = parseOption(i, argc, argv, arg, block);
+        } else if (arg == "--seconds") {
+            ok = parseOption(i, argc, argv, arg, seconds);
+        } else {
+            std::cerr << "Error: Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+        if (!ok) return 1;
+    }
+
+    int from = static_cast<int>(inputRate);
+    int to = static_cast<int>(outputRate);
+    size_t blockSize = static_cast<size_t>(block);
+    if (!PolyphaseResampler::isSupported(from, to) || blockSize == 0 || seconds <= 0) {
+        std::cerr << "Error: Invalid options" << std::endl;
+        return 1;
+    }
+
+    // Ten seconds of voice-like input, converted in packet-sized blocks
+    std::vector<int16_t> pcm = makeTestSignal("voice", from, 10.0);
+    pcm.resize(pcm.size() / blockSize * blockSize);
+    std::vector<float> input(pcm.size());
+    int16ToFloat(pcm.data(), input.data(), pcm.size());
+
+    {
+        PolyphaseResampler probe(from, to, blockSize);
+        std::cout << "Resample benchmark: " << from << " -> " << to << " Hz (L/M = " << probe.upFactor()
+                  << "/" << probe.downFactor() << ", " << probe.tapsPerPhase() << " taps per phase), "
+                  << blockSize << "-sample blocks" << std::endl;
+    }
+    std::cout << "  " << std::left << std::setw(10) << "kernel" << std::right
+              << std::setw(18) << "Msamples/s in" << std::setw(18) << "Msamples/s out"
+              << std::setw(16) << "x realtime" << std::endl;
+
+    for (PolyphaseResampler::Kernel kernel : {PolyphaseResampler::Kernel::Scalar, PolyphaseResampler::Kernel::Sse2,
+                                              PolyphaseResampler::Kernel::Avx2, PolyphaseResampler::Kernel::Neon}) {
+        if (!simdKernelAvailable(kernel)) continue;
+
+        PolyphaseResampler resampler(from, to, blockSize, kernel);
+        std::vector<float> output(resampler.maxOutput());
+        uint64_t samplesIn = 0;
+        uint64_t samplesOut = 0;
+        volatile float sink = 0.0f;
+
+        double cpuStart = threadCpuSeconds();
+        double cpuSeconds = 0.0;
+        while (cpuSeconds < seconds) {
+            for (size_t offset = 0; offset < input.size(); offset += blockSize) {
+                size_t produced = resampler.process(input.data() + offset, blockSize, output.data());
+                samplesOut += produced;
+                sink = output[0];
+            }
+            samplesIn += input.size();
+            cpuSeconds = threadCpuSeconds() - cpuStart;
+        }
+        (void)sink;
+
+        std::cout << "  " << std::left << std::setw(10) << simdKernelName(kernel) << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(18) << samplesIn / cpuSeconds / 1e6
+                  << std::setw(18) << samplesOut / cpuSeconds / 1e6
+                  << std::setw(16) << std::setprecision(0) << samplesIn / cpuSeconds / from << std::endl;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// mix: cost of one mixer period per stream count and kernel, one core
+
+int runMixBenchmark(int argc, char* argv[]) {
+    double sampleRate = 16000;
+    double packetMs = 20;
+    double seconds = 1;
+    double streamCount = 0;
+    AudioMixer::Summation summation = AudioMixer::Summation::Saturate;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--streams") {
+            ok = parseOption(i, argc, argv, arg, streamCount);
+        } else if (arg == "--sample-rate") {
+            ok = parseOption(i, argc, argv, arg, sampleRate);
+        } else if (arg == "--packet-ms") {
+            ok = parseOption(i, argc, argv, arg, packetMs);
+        } else if (arg == "--seconds") {
+            ok = parseOption(i, argc, argv, arg, seconds);
+        } else if (arg == "--softclip") {
+            summation = AudioMixer::Summation::SoftClip;
+        } else {
+            std::cerr << "Error: Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+        if (!ok) return 1;
+    }
+
+    int rate = static_cast<int>(sampleRate);
+    size_t packetSamples = static_cast<size_t>(rate * packetMs / 1000.0);
+    if (rate < 8000 || packetSamples == 0 || packetMs > 100 || seconds <= 0 || streamCount < 0) {
+        std::cerr << "Error: Invalid options" << std::endl;
+        return 1;
+    }
+
+    std::vector<size_t> counts = {64, 256, 1024};
+    if (streamCount > 0) counts = {static_cast<size_t>(streamCount)};
+
+    // Every stream plays the same voice-like signal from its own offset
+    std::vector<int16_t> pcm = makeTestSignal("voice", rate, 10.0);
+    auto period = std::chrono::duration_cast<AudioMixer::Clock::duration>(
+        std::chrono::duration<double, std::milli>(packetMs));
+    size_t sink = 0;
+    auto countSamples = [](const float*, size_t count, void* userData) {
+        *static_cast<size_t*>(userData) += count;
+    };
+
+    std::cout << "Mix benchmark: " << rate << " Hz, " << packetSamples << "-sample packets, "
+              << (summation == AudioMixer::Summation::SoftClip ? "soft clip" : "saturating") << std::endl;
+    std::cout << "  " << std::setw(8) << "streams" << "  " << std::left << std::setw(10) << "kernel" << std::right
+              << std::setw(16) << "us per packet" << std::setw(12) << "% of core"
+              << std::setw(18) << "Msamples/s in" << std::endl;
+
+    for (size_t streams : counts) {
+        for (SimdKernel kernel : {SimdKernel::Scalar, SimdKernel::Sse2, SimdKernel::Avx2, SimdKernel::Neon}) {
+            if (!simdKernelAvailable(kernel)) continue;
+
+            // Packet times advance synthetically, so the run is CPU bound and
+            // each period's mix is flushed as soon as every stream is added
+            AudioMixer mixer(rate, summation, 0.0, kernel);
+            std::vector<AudioMixer::Input> inputs(streams);
+            std::vector<size_t> offsets(streams);
+            for (size_t s = 0; s < streams; ++s) {
+                inputs[s].gain = 1.0f / std::sqrt(static_cast<float>(streams));
+                offsets[s] = (s * 7919 * packetSamples) % (pcm.size() - packetSamples);
+            }
+
+            auto time = AudioMixer::Clock::now();
+            uint64_t periods = 0;
+            double cpuStart = threadCpuSeconds();
+            double cpuSeconds = 0.0;
+            while (cpuSeconds < seconds) {
+                for (size_t s = 0; s < streams; ++s) {
+                    mixer.add(inputs[s], pcm.data() + offsets[s], packetSamples, time);
+                    offsets[s] += packetSamples;
+                    if (offsets[s] + packetSamples > pcm.size()) offsets[s] = 0;
+                }
+                time += period;
+                mixer.flush(time, countSamples, &sink);
+                if (++periods % 16 == 0) {
+                    cpuSeconds = threadCpuSeconds() - cpuStart;
+                }
+            }
+            cpuSeconds = threadCpuSeconds() - cpuStart;
+
+            double periodUs = cpuSeconds / periods * 1e6;
+            std::cout << "  " << std::setw(8) << streams << "  " << std::left << std::setw(10)
+                      << simdKernelName(kernel) << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(16) << periodUs
+                      << std::setw(12) << periodUs / (packetMs * 10.0)
+                      << std::setw(18) << periods * streams * packetSamples / cpuSeconds / 1e6 << std::endl;
+        }
+    }
+    return sink > 0 ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+// signal: test signal generation samples/second per core, per signal and oscillator
+
+int runSignalBenchmark(int argc, char* argv[]) {
+    double sampleRate = 16000;
+    double block = 320;
+    double seconds = 1;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--sample-rate") {
+            ok = parseOption(i, argc, argv, arg, sampleRate);
+        } else if (arg == "--block") {
+            ok = parseOption(i, argc, argv, arg, block);
+        } else if (arg == "--seconds") {
+            ok = parseOption(i, argc, argv, arg, seconds);
+        } else {
+            std::cerr << "Error: Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+        if (!ok) return 1;
+    }
+
+    int rate = static_cast<int>(sampleRate);
+    size_t blockSize = static_cast<size_t>(block);
+    if (rate < 8000 || blockSize == 0 || seconds <= 0) {
+        std::cerr << "Error: Invalid options" << std::endl;
+        return 1;
+    }
+
+    using Type = SignalConfig::Type;
+    using Oscillator = SignalConfig::Oscillator;
+    struct Case {
+        Type type;
+        Oscillator oscillator;
+    };
+    const Case cases[] = {
+        {Type::Tone, Oscillator::Wavetable},      {Type::Tone, Oscillator::Recursive},
+        {Type::Tone, Oscillator::Direct},         {Type::MultiTone, Oscillator::Wavetable},
+        {Type::MultiTone, Oscillator::Recursive}, {Type::MultiTone, Oscillator::Direct},
+        {Type::Chirp, Oscillator::Wavetable},     {Type::WhiteNoise, Oscillator::Wavetable},
+        {Type::PinkNoise, Oscillator::Wavetable},
+    };
+
+    SignalConfig base;
+    base.sampleRate = rate;
+    base.frequency = 997.0;
+    base.endFrequency = rate * 0.45;
+    base.frequencies = {300.0, 1000.0, 3000.0};
+    std::vector<int16_t> out(blockSize);
+
+    // Largest difference from the std::sin reference over ten seconds, in LSB
+    auto maxError = [&](SignalConfig config) {
+        std::unique_ptr<SignalGenerator> test = createSignalGenerator(config);
+        config.oscillator = Oscillator::Direct;
+        std::unique_ptr<SignalGenerator> reference = createSignalGenerator(config);
+        std::vector<int16_t> expected(blockSize);
+        int worst = 0;
+        for (size_t done = 0; done < static_cast<size_t>(rate) * 10; done += blockSize) {
+            test->generate(out.data(), blockSize);
+            reference->generate(expected.data(), blockSize);
+            for (size_t i = 0; i < blockSize; ++i) {
+                worst = std::max(worst, std::abs(out[i] - expected[i]));
+            }
+        }
+        return worst;
+    };
+
+    std::cout << "Signal benchmark: " << rate << " Hz, " << blockSize << "-sample blocks" << std::endl;
+    std::cout << "  " << std::left << std::setw(12) << "signal" << std::setw(12) << "oscillator" << std::right
+              << std::setw(14) << "Msamples/s" << std::setw(16) << "x realtime" << std::setw(16) << "max error LSB"
+              << std::endl;
+
+    // What the sender did before: a vector per packet and std::sin of the absolute time
+    {
+        const double PI = 3.14159265358979323846;
+        volatile int16_t sink = 0;
+        uint64_t samples = 0;
+        double cpuStart = threadCpuSeconds();
+        double cpuSeconds = 0.0;
+        while (cpuSeconds < seconds) {
+            for (int n = 0; n < 100; ++n) {
+                std::vector<int16_t> packet(blockSize);
+                for (size_t i = 0; i < blockSize; ++i) {
+                    double t = static_cast<double>(samples + i) / rate;
+                    packet[i] = static_cast<int16_t>(0.3 * std::sin(2.0 * PI * base.frequency * t) * 32767.0);
+                }
+                sink = packet[0];
+                samples += blockSize;
+            }
+            cpuSeconds = threadCpuSeconds() - cpuStart;
+        }
+        (void)sink;
+        std::cout << "  " << std::left << std::setw(12) << "tone" << std::setw(12) << "(baseline)" << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(14) << samples / cpuSeconds / 1e6
+                  << std::setw(16) << std::setprecision(0) << samples / cpuSeconds / rate << std::setw(16) << "-"
+                  << std::endl;
+    }
+
+    for (const Case& c : cases) {
+        SignalConfig config = base;
+        config.type = c.type;
+        config.oscillator = c.oscillator;
+        std::unique_ptr<SignalGenerator> generator = createSignalGenerator(config);
+        volatile int16_t sink = 0;
+        uint64_t samples = 0;
+
+        double cpuStart = threadCpuSeconds();
+        double cpuSeconds = 0.0;
+        while (cpuSeconds < seconds) {
+            for (int n = 0; n < 100; ++n) {
+                generator->generate(out.data(), blockSize);
+                sink = out[0];
+            }
+            samples += 100 * blockSize;
+            cpuSeconds = threadCpuSeconds() - cpuStart;
+        }
+        (void)sink;
+
+        bool sine = c.type == Type::Tone || c.type == Type::MultiTone;
+        bool oscillatorMatters = sine || c.type == Type::Chirp;
+        std::cout << "  " << std::left << std::setw(12) << signalTypeName(c.type) << std::setw(12)
+                  << (oscillatorMatters ? oscillatorName(c.oscillator) : "-") << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(14) << samples / cpuSeconds / 1e6 << std::setw(16)
+                  << std::setprecision(0) << samples / cpuSeconds / rate << std::setw(16)
+                  << (sine && c.oscillator != Oscillator::Direct ? std::to_string(maxError(config)) : "-")
+                  << std::endl;
+    }
+    return 0;
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " <benchmark> [options]" << std::endl;
+    std::cout << "Benchmarks:" << std::endl;
+    std::cout << "  receive                   Loopback packets/second per core, single vs recvmmsg batch" << std::endl;
+    std::cout << "    --batch <n>             recvmmsg batch size (default: 32)" << std::endl;
+    std::cout << "    --samples <n>           Samples per packet (default: 80)" << std::endl;
+    std::cout << "    --senders <n>           Sender threads (default: 2)" << std::endl;
+    std::cout << "    --seconds <s>           Measurement time per mode (default: 3)" << std::endl;
+    std::cout << "  conceal                   Loss concealment quality (SNR vs. the lost audio) and cost" << std::endl;
+    std::cout << "    --signal <voice|tone>   Test signal (default: voice)" << std::endl;
+    std::cout << "    --sample-rate <rate>    Sample rate in Hz (default: 16000)" << std::endl;
+    std::cout << "    --packet-ms <ms>        Packet duration (default: 20)" << std::endl;
+    std::cout << "    --loss <fraction>       Random packet loss rate (default: 0.05)" << std::endl;
+    std::cout << "    --seconds <s>           Signal length (default: 20)" << std::endl;
+    std::cout << "  resample                  Sample-rate conversion samples/second per core, per SIMD kernel" << std::endl;
+    std::cout << "    --from <rate>           Input rate in Hz (default: 16000)" << std::endl;
+    std::cout << "    --to <rate>             Output rate in Hz (default: 48000)" << std::endl;
+    std::cout << "    --block <n>             Input samples per call (default: 320)" << std::endl;
+    std::cout << "    --seconds <s>           Measurement time per kernel (default: 2)" << std::endl;
+    std::cout << "  mix                       Mixer cost per packet period at 64, 256 and 1024 streams, per SIMD kernel" << std::endl;
+    std::cout << "    --streams <n>           Benchmark only this many streams" << std::endl;
+    std::cout << "    --sample-rate <rate>    Sample rate in Hz (default: 16000)" << std::endl;
+    std::cout << "    --packet-ms <ms>        Packet duration (default: 20)" << std::endl;
+    std::cout << "    --softclip              Soft-clip instead of saturating summation" << std::endl;
+    std::cout << "    --seconds <s>           Measurement time per case (default: 1)" << std::endl;
+    std::cout << "  signal                    Test signal generation samples/second per core, per signal and oscillator" << std::endl;
+    std::cout << "    --sample-rate <rate>    Sample rate in Hz (default: 16000)" << std::endl;
+    std::cout << "    --block <n>             Samples per call (default: 320)" << std::endl;
+    std::cout << "    --seconds <s>           Measurement time per case (default: 1)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string benchmark = argv[1];
+    if (benchmark == "--help" || benchmark == "-h") {
+        printUsage(argv[0]);
+        return 0;
+    } else if (benchmark == "receive") {
+        return runReceiveBenchmark(argc, argv);
+    } else if (benchmark == "conceal") {
+        return runConcealBenchmark(argc, argv);
+    } else if (benchmark == "resample") {
+        return runResampleBenchmark(argc, argv);
+    } else if (benchmark == "mix") {
+        return runMixBenchmark(argc, argv);
+    } else if (benchmark == "signal") {
+        return runSignalBenchmark(argc, argv);
+    }
+
+    std::cerr << "Error: Unknown benchmark: " << benchmark << std::endl;
+    printUsage(argv[0]);
+    return 1;
+}
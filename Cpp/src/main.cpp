@@ -1,10 +1,13 @@
 #include "UDPAudioStreamer.h"
+#include "Logger.h"
 #include <iostream>
 #include <string>
 #include <csignal>
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <vector>
+#include <utility>
 
 std::unique_ptr<UDPAudioStreamer> g_streamer;
 
@@ -20,12 +23,34 @@ void printUsage(const char* programName) {
     std::cout << "Options:" << std::endl;
     std::cout << "  --sample-rate <rate>  Audio sample rate in Hz (default: 16000)" << std::endl;
     std::cout << "  --save-file <file>    Save received audio to WAV file (optional)" << std::endl;
+    std::cout << "  --playout-delay <ms>  Jitter buffer playout delay in ms (default: 60)" << std::endl;
+    std::cout << "  --reorder-window <ms> Max timestamp distance for reordering in ms (default: 500)" << std::endl;
+    std::cout << "  --concealment <mode>  Loss concealment: waveform, lpc, repeat or silence (default: waveform)" << std::endl;
+    std::cout << "  --adaptive-delay      Adapt the playout delay to measured network jitter" << std::endl;
+    std::cout << "  --no-drift-compensation  Play at the nominal rate instead of tracking the sender clock" << std::endl;
+    std::cout << "  --recv-batch <n>      Datagrams per receive syscall via recvmmsg (Linux, default: 1)" << std::endl;
+    std::cout << "  --workers <n>         Receive threads sharing the port via SO_REUSEPORT (Linux, default: 1)" << std::endl;
+    std::cout << "  --steer-by-source     Pin each sender to one worker with a BPF program (with --workers)" << std::endl;
+    std::cout << "  --output <sink>       Audio sink: device, null or file:<path> (raw PCM)" << std::endl;
+    std::cout << "                        (default: device, or null when there is none)" << std::endl;
+    std::cout << "  --output-rate <rate>  Output sample rate in Hz (default: the device's native rate," << std::endl;
+    std::cout << "                        or the stream's for null and file)" << std::endl;
+    std::cout << "  --output-format <fmt> Device sample format: auto, float32 or int16 (default: auto)" << std::endl;
+    std::cout << "  --dither              TPDF dither when reducing to int16 (default: round)" << std::endl;
+    std::cout << "  --gain <dB>           Playback gain, applied in float (default: 0)" << std::endl;
+    std::cout << "  --mix <summation>     Play all senders summed: saturate or softclip" << std::endl;
+    std::cout << "                        (default: only the first sender is played)" << std::endl;
+    std::cout << "  --stream-gain <addr:port>=<dB>  Gain for one sender in the mix (repeatable)" << std::endl;
+    std::cout << "  --stats-interval <s>  Print latency and jitter percentiles every <s> seconds" << std::endl;
+    std::cout << "  --stats-json          Print the periodic percentiles as JSON lines" << std::endl;
+    std::cout << "  --metrics-port <port> Serve Prometheus metrics on 127.0.0.1:<port>/metrics" << std::endl;
     std::cout << "  --help               Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << programName << " 8000" << std::endl;
     std::cout << "  " << programName << " 8000 --sample-rate 44100" << std::endl;
     std::cout << "  " << programName << " 8000 --save-file recording.wav" << std::endl;
+    std::cout << "  " << programName << " 8000 --mix softclip --stream-gain 10.0.0.5:40000=-6" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
@@ -33,6 +58,20 @@ int main(int argc, char* argv[]) {
     int port = 0;
     int sampleRate = 16000;
     std::string saveFile;
+    JitterBuffer::Config jitterConfig;
+    bool adaptiveDelay = false;
+    bool driftCompensation = true;
+    double gainDb = 0.0;
+    bool mixing = false;
+    AudioMixer::Summation summation = AudioMixer::Summation::Saturate;
+    std::vector<std::pair<std::string, double>> streamGains;
+    int receiveBatchSize = 1;
+    int receiveWorkers = 1;
+    bool steerBySource = false;
+    AudioOutputConfig outputConfig;
+    double statsInterval = 0.0;
+    bool statsJson = false;
+    int metricsPort = 0;
 
     // Parse command line arguments
     if (argc < 2) {
@@ -67,6 +106,225 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
             saveFile = argv[++i];
+        } else if (arg == "--playout-delay") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --playout-delay requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                jitterConfig.targetDelayMs = std::stod(argv[++i]);
+                if (jitterConfig.targetDelayMs < 0) {
+                    std::cerr << "Error: Playout delay must not be negative" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid playout delay: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--reorder-window") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --reorder-window requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                jitterConfig.reorderWindowMs = std::stod(argv[++i]);
+                if (jitterConfig.reorderWindowMs <= 0) {
+                    std::cerr << "Error: Reorder window must be positive" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid reorder window: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--concealment") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --concealment requires a value" << std::endl;
+                return 1;
+            }
+            std::string mode = argv[++i];
+            if (mode == "waveform") {
+                jitterConfig.concealment = JitterBuffer::Concealment::Waveform;
+            } else if (mode == "lpc") {
+                jitterConfig.concealment = JitterBuffer::Concealment::Lpc;
+            } else if (mode == "repeat") {
+                jitterConfig.concealment = JitterBuffer::Concealment::RepeatLast;
+            } else if (mode == "silence") {
+                jitterConfig.concealment = JitterBuffer::Concealment::Silence;
+            } else {
+                std::cerr << "Error: Invalid concealment mode: " << mode << std::endl;
+                return 1;
+            }
+        } else if (arg == "--adaptive-delay") {
+            adaptiveDelay = true;
+        } else if (arg == "--no-drift-compensation") {
+            driftCompensation = false;
+        } else if (arg == "--recv-batch") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --recv-batch requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                receiveBatchSize = std::stoi(argv[++i]);
+                if (receiveBatchSize < 1 || receiveBatchSize > 1024) {
+                    std::cerr << "Error: Receive batch size must be between 1 and 1024" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid receive batch size: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--workers") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --workers requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                receiveWorkers = std::stoi(argv[++i]);
+                if (receiveWorkers < 1 || receiveWorkers > 64) {
+                    std::cerr << "Error: Worker count must be between 1 and 64" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid worker count: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--steer-by-source") {
+            steerBySource = true;
+        } else if (arg == "--output") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --output requires a value" << std::endl;
+                return 1;
+            }
+            std::string sink = argv[++i];
+            if (sink == "device") {
+                outputConfig.type = AudioOutputConfig::Type::Device;
+                outputConfig.fallbackToNull = false;
+            } else if (sink == "null") {
+                outputConfig.type = AudioOutputConfig::Type::Null;
+            } else if (sink.rfind("file:", 0) == 0 && sink.size() > 5) {
+                outputConfig.type = AudioOutputConfig::Type::File;
+                outputConfig.path = sink.substr(5);
+            } else {
+                std::cerr << "Error: Invalid output: " << sink << std::endl;
+                return 1;
+            }
+        } else if (arg == "--output-format") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --output-format requires a value" << std::endl;
+                return 1;
+            }
+            std::string format = argv[++i];
+            if (format == "auto") {
+                outputConfig.sampleFormat = AudioOutputConfig::SampleFormat::Auto;
+            } else if (format == "float32") {
+                outputConfig.sampleFormat = AudioOutputConfig::SampleFormat::Float32;
+            } else if (format == "int16") {
+                outputConfig.sampleFormat = AudioOutputConfig::SampleFormat::Int16;
+            } else {
+                std::cerr << "Error: Invalid output format: " << format << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dither") {
+            outputConfig.dither = true;
+        } else if (arg == "--gain") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --gain requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                gainDb = std::stod(argv[++i]);
+                if (gainDb < -60.0 || gainDb > 40.0) {
+                    std::cerr << "Error: Gain must be between -60 and 40 dB" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid gain: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--mix") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --mix requires a value" << std::endl;
+                return 1;
+            }
+            std::string mode = argv[++i];
+            if (mode == "saturate") {
+                summation = AudioMixer::Summation::Saturate;
+            } else if (mode == "softclip") {
+                summation = AudioMixer::Summation::SoftClip;
+            } else {
+                std::cerr << "Error: Invalid mix summation: " << mode << std::endl;
+                return 1;
+            }
+            mixing = true;
+        } else if (arg == "--stream-gain") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --stream-gain requires a value" << std::endl;
+                return 1;
+            }
+            std::string spec = argv[++i];
+            size_t equals = spec.find('=');
+            if (equals == std::string::npos || equals == 0) {
+                std::cerr << "Error: Invalid stream gain: " << spec << std::endl;
+                return 1;
+            }
+            try {
+                double db = std::stod(spec.substr(equals + 1));
+                if (db < -60.0 || db > 40.0) {
+                    std::cerr << "Error: Gain must be between -60 and 40 dB" << std::endl;
+                    return 1;
+                }
+                streamGains.emplace_back(spec.substr(0, equals), db);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid stream gain: " << spec << std::endl;
+                return 1;
+            }
+        } else if (arg == "--output-rate") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --output-rate requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                outputConfig.sampleRate = std::stoi(argv[++i]);
+                if (outputConfig.sampleRate < 8000 || outputConfig.sampleRate > 384000) {
+                    std::cerr << "Error: Output rate must be between 8000 and 384000 Hz" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid output rate: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--stats-interval") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --stats-interval requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                statsInterval = std::stod(argv[++i]);
+                if (statsInterval <= 0) {
+                    std::cerr << "Error: Statistics interval must be positive" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid statistics interval: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--stats-json") {
+            statsJson = true;
+        } else if (arg == "--metrics-port") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --metrics-port requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                metricsPort = std::stoi(argv[++i]);
+                if (metricsPort < 1 || metricsPort > 65535) {
+                    std::cerr << "Error: Metrics port must be between 1 and 65535" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid metrics port: " << argv[i] << std::endl;
+                return 1;
+            }
         } else if (port == 0) {
             // First non-option argument should be the port
             try {
@@ -101,6 +359,22 @@ int main(int argc, char* argv[]) {
     
     try {
         g_streamer = std::make_unique<UDPAudioStreamer>(port, sampleRate, saveFile);
+        g_streamer->setJitterBufferConfig(jitterConfig);
+        g_streamer->setAdaptivePlayoutDelay(adaptiveDelay);
+        g_streamer->setReceiveBatchSize(static_cast<size_t>(receiveBatchSize));
+        g_streamer->setReceiveWorkers(static_cast<size_t>(receiveWorkers));
+        g_streamer->setSteerBySource(steerBySource);
+        g_streamer->setAudioOutput(outputConfig);
+        g_streamer->setDriftCompensation(driftCompensation);
+        g_streamer->setGainDb(gainDb);
+        g_streamer->setMixing(mixing, summation);
+        for (const auto& [source, db] : streamGains) {
+            g_streamer->setStreamGain(source, db);
+        }
+        g_streamer->setMetricsPort(metricsPort);
+
+        // Hot-path warnings are formatted and printed on the logger's thread
+        Logger::instance().start();
         
         if (!g_streamer->start()) {
             std::cerr << "Failed to start UDP Audio Streamer" << std::endl;
@@ -109,9 +383,22 @@ int main(int argc, char* argv[]) {
 
         std::cout << "Press Ctrl+C to stop..." << std::endl;
 
-        // Keep the main thread alive while the streamer runs
+        // Keep the main thread alive while the streamer runs, dumping
+        // percentiles from lock-free snapshots when asked to
+        auto statsPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(statsInterval));
+        auto nextStats = std::chrono::steady_clock::now() + statsPeriod;
         while (g_streamer->isRunning()) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+            if (statsInterval > 0 && std::chrono::steady_clock::now() >= nextStats) {
+                nextStats += statsPeriod;
+                std::string report = g_streamer->formatHistograms(g_streamer->getHistograms(), statsJson);
+                if (!statsJson) {
+                    std::cout << "Latency percentiles:" << std::endl;
+                }
+                std::cout << report << std::flush;
+            }
         }
 
     } catch (const std::exception& e) {
@@ -119,6 +406,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    Logger::instance().stop();
     std::cout << "UDP Audio Streamer finished" << std::endl;
     return 0;
 }
\ No newline at end of file
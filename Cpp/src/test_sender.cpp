@@ -6,6 +6,12 @@
 #include <chrono>
 #include <cstring>
 #include <algorithm>
+#include <sstream>
+#include <random>
+#include <atomic>
+#include <array>
+#include <iterator>
+#include <csignal>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -20,14 +26,316 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <cstdio>
 #endif
 
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <sys/prctl.h>
+#endif
+
+#include "Histogram.h"
+#include "SignalGenerator.h"
+
+// Cleared by SIGINT/SIGTERM so the send loops can print their totals
+std::atomic<bool> g_running{true};
+
+void signalHandler(int) {
+    g_running.store(false);
+}
+
+// std::signal restarts interrupted system calls on glibc, which would keep a
+// pacer blocked on its timerfd until the deadline; without SA_RESTART the
+// read returns EINTR and Ctrl+C takes effect at once
+void installSignalHandlers() {
+#ifdef _WIN32
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+#else
+    struct sigaction action {};
+    action.sa_handler = signalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+#endif
+}
+
+// Waits for absolute deadlines on the steady clock. On Linux a timerfd
+// armed with TFD_TIMER_ABSTIME on CLOCK_MONOTONIC (the clock steady_clock
+// reads) wakes the thread at the deadline itself, with no relative-sleep
+// rounding, and the thread's timer slack is cut from 50 us to 1 ns;
+// elsewhere sleep_until is used. With a spin time the thread wakes that much
+// early and busy-waits the rest, spending CPU for wakeup accuracy. SIGINT and
+// SIGTERM end a timerfd wait at once; sleep_until sleeps out its deadline.
+class Pacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Pacer(std::chrono::microseconds spin) : spin_(spin) {
+#ifdef __linux__
+        prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+        timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (timerFd_ < 0) {
+            perror("timerfd_create failed, pacing with sleep_until");
+        }
+#endif
+    }
+
+    ~Pacer() {
+#ifdef __linux__
+        if (timerFd_ >= 0) close(timerFd_);
+#endif
+    }
+
+    Pacer(const Pacer&) = delete;
+    Pacer& operator=(const Pacer&) = delete;
+
+    void waitUntil(Clock::time_point deadline) {
+        Clock::time_point wake = deadline - spin_;
+        if (Clock::now() < wake) {
+            sleepUntil(wake);
+        }
+        // A signal cuts the sleep short; do not spin out the rest of it
+        while (Clock::now() < deadline && g_running.load()) {
+        }
+    }
+
+    std::string describe() const {
+        std::string text = timerFd_ >= 0 ? "timerfd (absolute)" : "sleep_until";
+        if (spin_.count() > 0) text += ", spinning the last " + std::to_string(spin_.count()) + " us";
+        return text;
+    }
+
+private:
+    void sleepUntil(Clock::time_point wake) {
+#ifdef __linux__
+        if (timerFd_ >= 0) {
+            int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count();
+            itimerspec spec{};
+            spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+            spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+            if (timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, nullptr) == 0) {
+                uint64_t expirations;
+                while (read(timerFd_, &expirations, sizeof(expirations)) < 0 && errno == EINTR && g_running.load()) {
+                }
+                return;
+            }
+        }
+#endif
+        std::this_thread::sleep_until(wake);
+    }
+
+    std::chrono::microseconds spin_;
+    int timerFd_ = -1;
+};
+
+// Send time minus scheduled time, recorded in ns
+void printSendTimeError(const Histogram& histogram) {
+    Histogram::Snapshot snapshot = histogram.snapshot();
+    if (snapshot.count == 0) return;
+    std::cout << "Send time error: " << formatHistogramText(snapshot, 1e3, "us")
+              << ", mean " << snapshot.mean() / 1e3 << " us" << std::endl;
+}
+
+// Seeded model of a bad network path between the sender and the receiver.
+// Each generated packet may be lost, independently (Bernoulli) or in bursts
+// (a Gilbert-Elliott channel), delayed by jitter from a chosen distribution,
+// held back behind later packets, or duplicated. What survives goes into a
+// queue ordered by send time, so the generator keeps its own pacing however
+// the copies are delayed. Random numbers come from a fixed-algorithm
+// generator, so a seed reproduces the same impairments on any platform.
+class NetworkImpairment {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Packet = std::vector<uint8_t>;
+
+    enum class Jitter {
+        Uniform,        // U(0, scale)
+        Normal,         // |N(0, scale)|
+        Exponential,    // Mean scale
+        Pareto          // Lomax with shape 2 and mean scale: rare long delays
+    };
+
+    struct Config {
+        uint64_t seed = 1;
+        double lossRate = 0.0;          // Bernoulli loss probability
+        double burstEnter = 0.0;        // Gilbert-Elliott good to bad probability; 0 disables
+        double burstExit = 1.0;         // Bad to good probability per packet
+        double burstLoss = 1.0;         // Loss probability in the bad state
+        double reorderRate = 0.0;
+        int reorderDepth = 2;           // Packets a reordered one arrives behind
+        double duplicateRate = 0.0;
+        double jitterMs = 0.0;          // Distribution scale; 0 disables
+        Jitter jitter = Jitter::Uniform;
+    };
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t lost = 0;
+        uint64_t reordered = 0;
+        uint64_t duplicated = 0;
+        double delayMs = 0.0;           // Sum of added delays
+    };
+
+    NetworkImpairment(const Config& config, Clock::duration packetInterval)
+        : config_(config), interval_(packetInterval), state_(config.seed) {}
+
+    // Take a packet due at `time`; queues zero, one or two copies
+    void submit(Packet&& packet, Clock::time_point time) {
+        stats_.packets++;
+        if (isLost()) {
+            stats_.lost++;
+            recycle(std::move(packet));
+            return;
+        }
+
+        Clock::duration delay = jitterDelay();
+        if (config_.reorderRate > 0.0 && uniform() < config_.reorderRate) {
+            // Held just past the next `reorderDepth` packets
+            delay += interval_ * config_.reorderDepth + interval_ / 2;
+            stats_.reordered++;
+        }
+        stats_.delayMs += std::chrono::duration<double, std::milli>(delay).count();
+
+        if (config_.duplicateRate > 0.0 && uniform() < config_.duplicateRate) {
+            Packet copy = acquire();
+            copy.assign(packet.begin(), packet.end());
+            push(std::move(copy), time + delay + jitterDelay());
+            stats_.duplicated++;
+        }
+        push(std::move(packet), time + delay);
+    }
+
+    bool empty() const { return queue_.empty(); }
+    Clock::time_point nextSendTime() const { return queue_.front().time; }
+    size_t queued() const { return queue_.size(); }
+
+    // Remove the earliest queued packet; hand it back with recycle()
+    Packet pop() {
+        std::pop_heap(queue_.begin(), queue_.end(), Later());
+        Packet packet = std::move(queue_.back().packet);
+        queue_.pop_back();
+        return packet;
+    }
+
+    // Reuse the buffers of sent and lost packets
+    Packet acquire() {
+        if (free_.empty()) return Packet();
+        Packet packet = std::move(free_.back());
+        free_.pop_back();
+        return packet;
+    }
+
+    void recycle(Packet&& packet) { free_.push_back(std::move(packet)); }
+
+    // How long after its nominal time a packet can reasonably still be held:
+    // the reorder hold plus the jitter, doubled for a duplicate's second draw.
+    // The unbounded distributions are cut at 10 times their scale, beyond
+    // which under 1% of Pareto delays (and far fewer of the others) fall.
+    Clock::duration maxDelay() const {
+        double jitterMs = config_.jitter == Jitter::Uniform ? config_.jitterMs : 10.0 * config_.jitterMs;
+        if (config_.duplicateRate > 0.0) jitterMs *= 2.0;
+        Clock::duration delay = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(jitterMs));
+        if (config_.reorderRate > 0.0) {
+            delay += interval_ * config_.reorderDepth + interval_ / 2;
+        }
+        return delay;
+    }
+
+    const Config& config() const { return config_; }
+    const Stats& getStats() const { return stats_; }
+
+    static const char* jitterName(Jitter jitter) {
+        switch (jitter) {
+        case Jitter::Uniform: return "uniform";
+        case Jitter::Normal: return "normal";
+        case Jitter::Exponential: return "exponential";
+        case Jitter::Pareto: return "pareto";
+        }
+        return "unknown";
+    }
+
+private:
+    struct Entry {
+        Clock::time_point time;
+        uint64_t order;                 // Keeps equal times in submission order
+        Packet packet;
+    };
+
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.time != b.time ? a.time > b.time : a.order > b.order;
+        }
+    };
+
+    void push(Packet&& packet, Clock::time_point time) {
+        queue_.push_back({time, order_++, std::move(packet)});
+        std::push_heap(queue_.begin(), queue_.end(), Later());
+    }
+
+    bool isLost() {
+        bool lost = config_.lossRate > 0.0 && uniform() < config_.lossRate;
+        if (config_.burstEnter > 0.0) {
+            badState_ = badState_ ? uniform() >= config_.burstExit : uniform() < config_.burstEnter;
+            if (badState_ && uniform() < config_.burstLoss) lost = true;
+        }
+        return lost;
+    }
+
+    Clock::duration jitterDelay() {
+        if (config_.jitterMs <= 0.0) return Clock::duration::zero();
+        double u = uniform();
+        double ms = 0.0;
+        switch (config_.jitter) {
+        case Jitter::Uniform:
+            ms = config_.jitterMs * u;
+            break;
+        case Jitter::Normal: {
+            // Box-Muller; 1 - u keeps the logarithm finite
+            double v = uniform();
+            ms = config_.jitterMs * std::fabs(std::sqrt(-2.0 * std::log(1.0 - u)) * std::cos(2.0 * M_PI * v));
+            break;
+        }
+        case Jitter::Exponential:
+            ms = -config_.jitterMs * std::log(1.0 - u);
+            break;
+        case Jitter::Pareto:
+            ms = config_.jitterMs * (1.0 / std::sqrt(1.0 - u) - 1.0);
+            break;
+        }
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+    }
+
+    // splitmix64, uniform in [0, 1)
+    double uniform() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    Config config_;
+    Clock::duration interval_;
+    uint64_t state_;
+    bool badState_ = false;
+    std::vector<Entry> queue_;          // Min-heap on send time
+    std::vector<Packet> free_;
+    uint64_t order_ = 0;
+    Stats stats_;
+};
+
 class UDPTestSender {
 public:
-    UDPTestSender(const std::string& host, int port, int sampleRate = 16000, 
-                  double frequency = 440.0, double packetDuration = 0.02)
-        : host_(host), port_(port), sampleRate_(sampleRate), 
-          frequency_(frequency), packetDuration_(packetDuration) {
+    // The signal's own sample rate is ignored; packets carry `sampleRate`
+    UDPTestSender(const std::string& host, int port, int sampleRate = 16000,
+                  const SignalConfig& signal = SignalConfig(), double packetDuration = 0.02)
+        : host_(host), port_(port), sampleRate_(sampleRate),
+          packetDuration_(packetDuration), signal_(signal) {
 #ifdef _WIN32
         socket_ = INVALID_SOCKET;
 #else
@@ -39,6 +347,9 @@ public:
         cleanup();
     }
 
+    // Stop after this many seconds; 0 sends until interrupted
+    void setDuration(double seconds) { durationSeconds_ = seconds; }
+
     bool initialize() {
 #ifdef _WIN32
         // Initialize Winsock
@@ -89,99 +400,194 @@ public:
             return;
         }
 
+        SignalConfig signal = signal_;
+        signal.sampleRate = sampleRate_;
+        std::unique_ptr<SignalGenerator> generator = createSignalGenerator(signal);
+
         std::cout << "Sending audio packets to " << host_ << ":" << port_ << std::endl;
         std::cout << "Sample rate: " << sampleRate_ << " Hz" << std::endl;
-        std::cout << "Tone frequency: " << frequency_ << " Hz" << std::endl;
+        std::cout << "Signal: " << generator->describe() << std::endl;
         std::cout << "Packet duration: " << packetDuration_ << " seconds" << std::endl;
         std::cout << "Frame format: [2-byte seq#][4-byte sample timestamp][audio samples]" << std::endl;
+        printImpairment();
         std::cout << "Press Ctrl+C to stop" << std::endl;
 
+        using Clock = NetworkImpairment::Clock;
         int samplesPerPacket = static_cast<int>(sampleRate_ * packetDuration_);
-        uint16_t sequenceNumber = 0;
-        uint32_t sampleTimestamp = 0;
+        auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(packetDuration_));
+        NetworkImpairment network(impairment_, interval);
+
+        // Start close enough to the wrap for both counters to cross it
+        // after wrapAfter_ packets
+        uint16_t sequenceNumber = static_cast<uint16_t>(-wrapAfter_);
+        uint32_t sampleTimestamp = static_cast<uint32_t>(-wrapAfter_ * static_cast<int64_t>(samplesPerPacket));
+        std::vector<int16_t> samples(static_cast<size_t>(samplesPerPacket));
         uint64_t packetCount = 0;
+        uint64_t packetsSent = 0;
 
-        auto startTime = std::chrono::high_resolution_clock::now();
+        Pacer pacer(spin_);
+        Histogram sendTimeError;
+        std::cout << "Pacing: " << pacer.describe() << std::endl;
+
+        auto startTime = Clock::now();
         auto nextPacketTime = startTime;
+        auto drainDeadline = Clock::time_point::max();
+        bool generating = true;
 
         try {
-            while (true) {
-                // Generate sine wave samples for this packet
-                std::vector<int16_t> samples = generateSineWave(samplesPerPacket, sampleTimestamp);
-
-                // Create packet: [2 bytes seq][4 bytes timestamp][audio samples]
-                std::vector<uint8_t> packet(6 + samples.size() * 2);
-                
-                // Pack header (little-endian)
-                std::memcpy(packet.data(), &sequenceNumber, 2);
-                std::memcpy(packet.data() + 2, &sampleTimestamp, 4);
-                
-                // Pack audio samples (little-endian)
-                std::memcpy(packet.data() + 6, samples.data(), samples.size() * 2);
-
-                // Send packet
-#ifdef _WIN32
-                int result = sendto(socket_, reinterpret_cast<const char*>(packet.data()), 
-                                  static_cast<int>(packet.size()), 0,
-                                  reinterpret_cast<const sockaddr*>(&addr_), sizeof(addr_));
-                if (result == SOCKET_ERROR) {
-                    std::cerr << "Send failed: " << WSAGetLastError() << std::endl;
-                    break;
+            while (g_running.load()) {
+                // Send first: whatever is due was built ahead of its time
+                auto now = Clock::now();
+                while (!network.empty() && network.nextSendTime() <= now) {
+                    auto scheduled = network.nextSendTime();
+                    NetworkImpairment::Packet packet = network.pop();
+                    auto lateness = Clock::now() - scheduled;
+                    bool sent = sendPacket(packet);
+                    network.recycle(std::move(packet));
+                    if (!sent) {
+                        g_running.store(false);
+                        break;
+                    }
+                    sendTimeError.record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count()));
+                    packetsSent++;
                 }
-#else
-                ssize_t result = sendto(socket_, packet.data(), packet.size(), 0,
-                                      reinterpret_cast<const sockaddr*>(&addr_), sizeof(addr_));
-                if (result < 0) {
-                    perror("Send failed");
-                    break;
+
+                if (generating && durationSeconds_ > 0.0 &&
+                    std::chrono::duration<double>(nextPacketTime - startTime).count() >= durationSeconds_) {
+                    // Let packets still held by the impairment go out, but
+                    // not the rare ones a heavy-tailed delay put far out
+                    generating = false;
+                    drainDeadline = nextPacketTime + network.maxDelay();
                 }
-#endif
+                if (!generating && (network.empty() || now >= drainDeadline)) break;
+
+                // Build each packet one interval ahead, so its deadline only has a send to do
+                if (generating && now + interval >= nextPacketTime) {
+                    // Continue the signal where the last packet ended
+                    generator->generate(samples.data(), samples.size());
+
+                    // Create packet: [2 bytes seq][4 bytes timestamp][audio samples]
+                    NetworkImpairment::Packet packet = network.acquire();
+                    packet.resize(6 + samples.size() * 2);
+
+                    // Pack header (little-endian)
+                    std::memcpy(packet.data(), &sequenceNumber, 2);
+                    std::memcpy(packet.data() + 2, &sampleTimestamp, 4);
+
+                    // Pack audio samples (little-endian)
+                    std::memcpy(packet.data() + 6, samples.data(), samples.size() * 2);
+
+                    // Queue it at its nominal time, or later when impaired
+                    network.submit(std::move(packet), nextPacketTime);
+
+                    // Update counters
+                    sequenceNumber++;
+                    sampleTimestamp += samplesPerPacket;
+                    packetCount++;
 
-                // Update counters
-                sequenceNumber++;
-                sampleTimestamp += samplesPerPacket;
-                packetCount++;
+                    // Status update every 50 packets
+                    if (packetCount % 50 == 0) {
+                        std::cout << "Sent " << packetCount << " packets (seq: "
+                                  << static_cast<uint16_t>(sequenceNumber - 1) << ", timestamp: "
+                                  << (sampleTimestamp - samplesPerPacket) << ")..." << std::endl;
+                    }
 
-                // Status update every 50 packets
-                if (packetCount % 50 == 0) {
-                    std::cout << "Sent " << packetCount << " packets (seq: " 
-                              << (sequenceNumber - 1) << ", timestamp: " 
-                              << (sampleTimestamp - samplesPerPacket) << ")..." << std::endl;
+                    nextPacketTime = startTime + interval * static_cast<int64_t>(packetCount);
                 }
 
-                // Wait for next packet time
-                nextPacketTime += std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
-                    std::chrono::duration<double>(packetDuration_));
-                
-                std::this_thread::sleep_until(nextPacketTime);
+                // Wait for the next release, or the next packet to build
+                auto wake = Clock::time_point::max();
+                if (generating) {
+                    wake = nextPacketTime - interval;
+                }
+                if (!network.empty()) {
+                    wake = std::min({wake, network.nextSendTime(), drainDeadline});
+                }
+                pacer.waitUntil(wake);
             }
         } catch (const std::exception& e) {
             std::cerr << "Error: " << e.what() << std::endl;
         }
 
         std::cout << "\nSent " << packetCount << " total packets" << std::endl;
-        std::cout << "Final sequence number: " << (sequenceNumber - 1) << std::endl;
+        std::cout << "Final sequence number: " << static_cast<uint16_t>(sequenceNumber - 1) << std::endl;
         std::cout << "Final sample timestamp: " << (sampleTimestamp - samplesPerPacket) << std::endl;
+        printSendTimeError(sendTimeError);
+        if (impairmentEnabled()) {
+            const NetworkImpairment::Stats& stats = network.getStats();
+            uint64_t delivered = stats.packets - stats.lost;
+            std::cout << "Impairment: " << stats.lost << " lost, " << stats.reordered << " reordered, "
+                      << stats.duplicated << " duplicated, mean added delay "
+                      << (delivered ? stats.delayMs / delivered : 0.0) << " ms" << std::endl;
+            std::cout << "Datagrams on the wire: " << packetsSent << " (" << network.queued()
+                      << " still held at exit)" << std::endl;
+        }
     }
 
+    // Must be called before sendAudioPackets()
+    void setImpairment(const NetworkImpairment::Config& config) { impairment_ = config; }
+    // Start the sequence number and timestamp this many packets before they wrap
+    void setWrapAfter(int packets) { wrapAfter_ = packets; }
+    // Busy-wait this long before each deadline instead of sleeping
+    void setSpin(std::chrono::microseconds spin) { spin_ = spin; }
+
 private:
-    std::vector<int16_t> generateSineWave(int numSamples, uint32_t startingSampleIndex) {
-        std::vector<int16_t> samples(numSamples);
-        const double amplitude = 0.3;
-        
-        for (int i = 0; i < numSamples; ++i) {
-            double t = static_cast<double>(startingSampleIndex + i) / sampleRate_;
-            double sample = amplitude * std::sin(2.0 * M_PI * frequency_ * t);
-            
-            // Convert to 16-bit signed integer
-            int32_t sampleInt = static_cast<int32_t>(sample * 32767.0);
-            // Clamp to 16-bit range
-            if (sampleInt > 32767) sampleInt = 32767;
-            if (sampleInt < -32768) sampleInt = -32768;
-            samples[i] = static_cast<int16_t>(sampleInt);
+    bool impairmentEnabled() const {
+        return impairment_.lossRate > 0.0 || impairment_.burstEnter > 0.0 || impairment_.reorderRate > 0.0 ||
+               impairment_.duplicateRate > 0.0 || impairment_.jitterMs > 0.0;
+    }
+
+    void printImpairment() const {
+        if (wrapAfter_ > 0) {
+            std::cout << "Sequence number and timestamp wrap after " << wrapAfter_ << " packets" << std::endl;
         }
-        
-        return samples;
+        if (!impairmentEnabled()) return;
+
+        const NetworkImpairment::Config& c = impairment_;
+        std::vector<std::string> parts;
+        auto describe = [&](auto&&... fields) {
+            std::ostringstream part;
+            (part << ... << fields);
+            parts.push_back(part.str());
+        };
+        if (c.lossRate > 0.0) describe("loss ", c.lossRate * 100.0, "%");
+        if (c.burstEnter > 0.0) {
+            describe("burst loss ", c.burstEnter * 100.0, "%/", c.burstExit * 100.0,
+                     "% (bad state loses ", c.burstLoss * 100.0, "%)");
+        }
+        if (c.reorderRate > 0.0) describe("reorder ", c.reorderRate * 100.0, "% by ", c.reorderDepth);
+        if (c.duplicateRate > 0.0) describe("duplicate ", c.duplicateRate * 100.0, "%");
+        if (c.jitterMs > 0.0) describe(NetworkImpairment::jitterName(c.jitter), " jitter ", c.jitterMs, " ms");
+
+        std::cout << "Impairment (seed " << c.seed << "): ";
+        for (size_t i = 0; i < parts.size(); ++i) {
+            std::cout << (i ? ", " : "") << parts[i];
+        }
+        std::cout << std::endl;
+    }
+
+    bool sendPacket(const NetworkImpairment::Packet& packet) {
+#ifdef _WIN32
+        int result = sendto(socket_, reinterpret_cast<const char*>(packet.data()),
+                            static_cast<int>(packet.size()), 0,
+                            reinterpret_cast<const sockaddr*>(&addr_), sizeof(addr_));
+        if (result == SOCKET_ERROR) {
+            std::cerr << "Send failed: " << WSAGetLastError() << std::endl;
+            return false;
+        }
+#else
+        ssize_t result;
+        do {
+            result = sendto(socket_, packet.data(), packet.size(), 0,
+                            reinterpret_cast<const sockaddr*>(&addr_), sizeof(addr_));
+        } while (result < 0 && errno == EINTR);
+        if (result < 0) {
+            perror("Send failed");
+            return false;
+        }
+#endif
+        return true;
     }
 
     void cleanup() {
@@ -202,8 +608,12 @@ private:
     std::string host_;
     int port_;
     int sampleRate_;
-    double frequency_;
     double packetDuration_;
+    SignalConfig signal_;
+    double durationSeconds_ = 0.0;
+    NetworkImpairment::Config impairment_;
+    int wrapAfter_ = 0;
+    std::chrono::microseconds spin_{0};
 
 #ifdef _WIN32
     SOCKET socket_;
@@ -213,18 +623,423 @@ private:
     sockaddr_in addr_;
 };
 
+#ifndef _WIN32
+// Emulates many sender nodes from one process to load-test the receiver.
+// Every virtual stream keeps its own sequence and timestamp counters.
+// Packets are assembled from a 6-byte header written into the batch slot
+// and a payload pointing into a precomputed loop of signal, so nothing is
+// allocated or copied per packet. They go out in sendmmsg batches at a
+// fixed aggregate rate, with the streams interleaved evenly.
+//
+// The receiver tells senders apart by source address and port. Towards a
+// loopback destination all streams share one socket and each gets its own
+// source address in 127.0.0.0/8 through IP_PKTINFO, so a whole batch is
+// one syscall (Linux). Otherwise each stream has a socket, and so a port,
+// of its own, and a batch ends where the socket changes.
+class LoadGenerator {
+public:
+    struct Config {
+        size_t streams = 100;
+        double packetsPerSecond = 0.0;   // Aggregate; 0 sends every stream in real time
+        size_t batchSize = 32;
+        double durationSeconds = 0.0;    // 0 runs until interrupted
+        std::chrono::microseconds spin{0};   // Busy-wait before each deadline
+    };
+
+    LoadGenerator(const std::string& host, int port, int sampleRate, const SignalConfig& signal,
+                  double packetDuration, const Config& config)
+        : host_(host), port_(port), sampleRate_(sampleRate), signal_(signal), config_(config) {
+        samplesPerPacket_ = std::max<size_t>(1, static_cast<size_t>(sampleRate * packetDuration));
+        if (config_.packetsPerSecond <= 0.0) {
+            config_.packetsPerSecond = config_.streams / packetDuration;
+        }
+        config_.batchSize = std::clamp<size_t>(config_.batchSize, 1, MAX_BATCH);
+    }
+
+    ~LoadGenerator() {
+        for (int fd : sockets_) {
+            close(fd);
+        }
+    }
+
+    bool run() {
+        if (!initialize()) {
+            std::cerr << "Failed to initialize load generator" << std::endl;
+            return false;
+        }
+
+        double rate = config_.packetsPerSecond;
+        std::cout << "Load test: " << streams_.size() << " virtual streams to " << host_ << ":" << port_ << std::endl;
+        std::cout << "Sample rate: " << sampleRate_ << " Hz, " << samplesPerPacket_ << " samples per packet" << std::endl;
+        std::cout << "Signal: " << signalDescription_ << std::endl;
+        std::cout << "Target rate: " << rate << " packets/s (" << rate / streams_.size() << " per stream)" << std::endl;
+        std::cout << "Batch size: " << config_.batchSize << " packets"
+#ifdef __linux__
+                  << " (sendmmsg)"
+#endif
+                  << std::endl;
+        if (sharedSocket_) {
+            std::cout << "Sources: " << formatSource(streams_.front()) << " to " << formatSource(streams_.back())
+                      << " on one socket" << std::endl;
+        } else {
+            std::cout << "Sources: one socket per stream" << std::endl;
+        }
+        std::cout << "Press Ctrl+C to stop" << std::endl;
+
+        using Clock = Pacer::Clock;
+        Pacer pacer(config_.spin);
+        Histogram sendTimeError;     // Includes the wait for a batch to fill
+        std::cout << "Pacing: " << pacer.describe() << std::endl;
+
+        auto toDuration = [](double seconds) {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        };
+        const auto maxDelay = std::chrono::microseconds(MAX_BATCH_DELAY_US);
+        auto start = Clock::now();
+        auto lastReport = start;
+        uint64_t reportSent = 0;
+        uint64_t reportCalls = 0;
+        uint64_t next = 0;    // Packet n is due at start + n / rate
+
+        while (g_running.load()) {
+            auto now = Clock::now();
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            if (config_.durationSeconds > 0.0 && elapsed >= config_.durationSeconds) break;
+
+            if (now - lastReport >= std::chrono::seconds(1)) {
+                double seconds = std::chrono::duration<double>(now - lastReport).count();
+                uint64_t sent = packetsSent_ - reportSent;
+                uint64_t calls = sendCalls_ - reportCalls;
+                std::cout << "Sent " << packetsSent_ << " packets: " << static_cast<uint64_t>(sent / seconds)
+                          << " packets/s (target " << static_cast<uint64_t>(rate) << "), "
+                          << sent * packetBytes() * 8 / seconds / 1e6 << " Mbit/s, "
+                          << (calls ? static_cast<double>(sent) / calls : 0.0) << " packets per call" << std::endl;
+                lastReport = now;
+                reportSent = packetsSent_;
+                reportCalls = sendCalls_;
+            }
+
+            // Send once a full batch is due, or once the oldest due packet
+            // has waited MAX_BATCH_DELAY_US
+            uint64_t due = static_cast<uint64_t>(elapsed * rate) + 1;
+            auto oldestDue = start + toDuration(next / rate);
+            if (due < next + config_.batchSize && (due <= next || now < oldestDue + maxDelay)) {
+                auto batchDue = start + toDuration((next + config_.batchSize - 1) / rate);
+                pacer.waitUntil(std::min(batchDue, oldestDue + maxDelay));
+                continue;
+            }
+
+            auto sendTime = Clock::now();
+            size_t built = transmit(next, static_cast<size_t>(std::min<uint64_t>(due - next, config_.batchSize)));
+            for (size_t i = 0; i < built; ++i) {
+                auto lateness = sendTime - (start + toDuration((next + i) / rate));
+                sendTimeError.record(static_cast<uint64_t>(
+                    std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count())));
+            }
+            next += built;
+        }
+
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "\nSent " << packetsSent_ << " total packets in " << elapsed << " s" << std::endl;
+        std::cout << "Achieved rate: " << static_cast<uint64_t>(packetsSent_ / elapsed) << " packets/s (target "
+                  << static_cast<uint64_t>(rate) << "), "
+                  << packetsSent_ * packetBytes() * 8 / elapsed / 1e6 << " Mbit/s" << std::endl;
+        std::cout << "Send calls: " << sendCalls_ << " ("
+                  << (sendCalls_ ? static_cast<double>(packetsSent_) / sendCalls_ : 0.0) << " packets per call)" << std::endl;
+        printSendTimeError(sendTimeError);
+        if (packetsFailed_ > 0) {
+            std::cout << "Packets not sent: " << packetsFailed_ << " (last error: " << std::strerror(lastError_)
+                      << ")" << std::endl;
+        }
+        return true;
+    }
+
+private:
+    struct VirtualStream {
+        int socket = -1;
+        in_addr source{};     // Source address on a shared socket
+        uint16_t sequence = 0;
+        uint32_t timestamp = 0;
+        size_t phase = 0;     // Offset into the tone, so streams differ
+    };
+
+    bool initialize() {
+        dest_.sin_family = AF_INET;
+        dest_.sin_port = htons(static_cast<uint16_t>(port_));
+        if (inet_pton(AF_INET, host_.c_str(), &dest_.sin_addr) <= 0) {
+            std::cerr << "Invalid address: " << host_ << std::endl;
+            return false;
+        }
+
+        // One loop of signal and a packet more, so every payload is one
+        // contiguous slice. The loop is a second long, or one sweep for a
+        // chirp. It repeats without a waveform jump: tones are rounded to
+        // whole cycles per second, and a chirp's end frequency is moved (by
+        // at most sampleRate / sweep samples Hz) so the sweep holds a whole
+        // number of cycles. The chirp's frequency still resets each sweep.
+        SignalConfig signal = signal_;
+        signal.sampleRate = sampleRate_;
+        signal.frequency = std::max(1.0, std::round(signal.frequency));
+        for (double& frequency : signal.frequencies) {
+            frequency = std::max(1.0, std::round(frequency));
+        }
+        loopSamples_ = static_cast<size_t>(sampleRate_);
+        if (signal.type == SignalConfig::Type::Chirp) {
+            signal.frequency = signal_.frequency;
+            loopSamples_ = std::max<size_t>(2, static_cast<size_t>(signal.sweepSeconds * sampleRate_));
+            signal.sweepSeconds = static_cast<double>(loopSamples_) / sampleRate_;
+            signal.endFrequency = wholeCycleChirpEnd(signal, loopSamples_);
+        }
+        std::unique_ptr<SignalGenerator> generator = createSignalGenerator(signal);
+        signalDescription_ = generator->describe();
+        loop_.resize(loopSamples_ + samplesPerPacket_);
+        generator->generate(loop_.data(), loopSamples_);
+        std::copy_n(loop_.begin(), samplesPerPacket_, loop_.begin() + loopSamples_);
+
+#ifdef __linux__
+        sharedSocket_ = (ntohl(dest_.sin_addr.s_addr) >> 24) == 127;
+#endif
+
+        streams_.resize(config_.streams);
+        for (size_t i = 0; i < streams_.size(); ++i) {
+            VirtualStream& stream = streams_[i];
+            if (!sharedSocket_ || sockets_.empty()) {
+                int fd = socket(AF_INET, SOCK_DGRAM, 0);
+                if (fd < 0) {
+                    perror("Socket creation failed");
+                    if (errno == EMFILE) {
+                        std::cerr << "Raise the open file limit (ulimit -n) for " << streams_.size()
+                                  << " streams" << std::endl;
+                    }
+                    return false;
+                }
+                sockets_.push_back(fd);
+            }
+            stream.socket = sockets_.back();
+            if (sharedSocket_) {
+                stream.source.s_addr = htonl(FIRST_SOURCE + static_cast<uint32_t>(i));
+            }
+            stream.phase = (i * 7919) % loopSamples_;
+        }
+
+        headers_.resize(config_.batchSize);
+        iov_.resize(config_.batchSize);
+        messages_.resize(config_.batchSize);
+        control_.resize(config_.batchSize);
+        return true;
+    }
+
+    // Build and send up to `count` packets starting with packet `first`;
+    // returns how many were built, sent or not
+    size_t transmit(uint64_t first, size_t count) {
+        int fd = streams_[first % streams_.size()].socket;
+        size_t built = 0;
+        for (; built < count; ++built) {
+            VirtualStream& stream = streams_[(first + built) % streams_.size()];
+            if (stream.socket != fd) break;
+
+            uint8_t* header = headers_[built].data();
+            std::memcpy(header, &stream.sequence, 2);
+            std::memcpy(header + 2, &stream.timestamp, 4);
+            size_t offset = (stream.timestamp + stream.phase) % loopSamples_;
+            iov_[built][0] = {header, HEADER_SIZE};
+            iov_[built][1] = {loop_.data() + offset, samplesPerPacket_ * sizeof(int16_t)};
+            stream.sequence++;
+            stream.timestamp += static_cast<uint32_t>(samplesPerPacket_);
+
+            msghdr& msg = message(built);
+            msg = msghdr{};
+            msg.msg_name = &dest_;
+            msg.msg_namelen = sizeof(dest_);
+            msg.msg_iov = iov_[built].data();
+            msg.msg_iovlen = 2;
+#ifdef __linux__
+            if (sharedSocket_) {
+                msg.msg_control = control_[built].data();
+                msg.msg_controllen = control_[built].size();
+                cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_level = IPPROTO_IP;
+                cmsg->cmsg_type = IP_PKTINFO;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(in_pktinfo));
+                in_pktinfo info{};
+                info.ipi_spec_dst = stream.source;
+                std::memcpy(CMSG_DATA(cmsg), &info, sizeof(info));
+            }
+#endif
+        }
+
+        size_t sent = 0;
+        while (sent < built) {
+#ifdef __linux__
+            int result = sendmmsg(fd, messages_.data() + sent, static_cast<unsigned int>(built - sent), 0);
+#else
+            int result = sendmsg(fd, &messages_[sent], 0) < 0 ? -1 : 1;
+#endif
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                lastError_ = errno;
+                break;
+            }
+            sendCalls_++;
+            sent += static_cast<size_t>(result);
+        }
+        packetsSent_ += sent;
+        packetsFailed_ += built - sent;
+        return built;
+    }
+
+    // End frequency near the requested one for which a linear sweep over
+    // `samples` advances the phase by a whole number of cycles. The chirp
+    // steps its frequency linearly per sample, so the sweep covers
+    //   cycles = (samples * start + (end - start) * (samples - 1) / 2) / rate
+    static double wholeCycleChirpEnd(const SignalConfig& signal, size_t samples) {
+        double n = static_cast<double>(samples);
+        double rate = signal.sampleRate;
+        auto endFor = [&](double cycles) {
+            return signal.frequency + (cycles * rate - n * signal.frequency) * 2.0 / (n - 1.0);
+        };
+        double cycles = std::round((n * signal.frequency + (signal.endFrequency - signal.frequency) * (n - 1.0) / 2.0) / rate);
+        double end = endFor(cycles);
+        if (end >= rate / 2.0) end = endFor(cycles - 1.0);
+        return std::max(1.0, end);
+    }
+
+    size_t packetBytes() const { return HEADER_SIZE + samplesPerPacket_ * sizeof(int16_t); }
+
+    static std::string formatSource(const VirtualStream& stream) {
+        char text[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &stream.source, text, sizeof(text));
+        return text;
+    }
+
+#ifdef __linux__
+    msghdr& message(size_t i) { return messages_[i].msg_hdr; }
+#else
+    msghdr& message(size_t i) { return messages_[i]; }
+#endif
+
+    static constexpr size_t MAX_BATCH = 1024;
+    static constexpr size_t HEADER_SIZE = 6;
+    static constexpr int MAX_BATCH_DELAY_US = 1000;      // Longest a due packet waits for its batch
+    static constexpr uint32_t FIRST_SOURCE = 0x7F010001; // 127.1.0.1
+
+    std::string host_;
+    int port_;
+    int sampleRate_;
+    SignalConfig signal_;
+    Config config_;
+    size_t samplesPerPacket_;
+
+    sockaddr_in dest_{};
+    bool sharedSocket_ = false;
+    std::vector<int> sockets_;
+    std::vector<VirtualStream> streams_;
+    std::vector<int16_t> loop_;
+    size_t loopSamples_ = 0;
+    std::string signalDescription_;
+
+    // One slot per packet in a batch
+    std::vector<std::array<uint8_t, HEADER_SIZE>> headers_;
+    std::vector<std::array<iovec, 2>> iov_;
+#ifdef __linux__
+    std::vector<mmsghdr> messages_;
+    std::vector<std::array<uint8_t, CMSG_SPACE(sizeof(in_pktinfo))>> control_;
+#else
+    std::vector<msghdr> messages_;
+    std::vector<std::array<uint8_t, 1>> control_;
+#endif
+
+    uint64_t packetsSent_ = 0;
+    uint64_t packetsFailed_ = 0;
+    uint64_t sendCalls_ = 0;
+    int lastError_ = 0;
+};
+#endif
+
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " <host> <port> [options]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  --sample-rate <rate>      Audio sample rate in Hz (default: 16000)" << std::endl;
-    std::cout << "  --frequency <freq>        Sine wave frequency in Hz (default: 440.0)" << std::endl;
+    std::cout << "  --frequency <freq>        Sine wave frequency in Hz; a chirp's start (default: 440.0)" << std::endl;
     std::cout << "  --packet-duration <dur>   Duration of each packet in seconds (default: 0.02)" << std::endl;
+    std::cout << "  --duration <s>            Stop after <s> seconds (default: run until Ctrl+C)" << std::endl;
+    std::cout << "  --spin <us>               Busy-wait the last <us> before each send for tighter pacing" << std::endl;
+    std::cout << "                            (default: 0, timerfd wakeups only on Linux)" << std::endl;
+    std::cout << "Signal:" << std::endl;
+    std::cout << "  --signal <type>           tone, white, pink, chirp or multitone (default: tone)" << std::endl;
+    std::cout << "  --oscillator <osc>        Sine computation: table (interpolated wavetable), recursive" << std::endl;
+    std::cout << "                            (rotating phasor) or direct (std::sin) (default: table)" << std::endl;
+    std::cout << "  --frequencies <f1,f2,..>  Multi-tone frequencies in Hz (default: 300,1000,3000)" << std::endl;
+    std::cout << "  --chirp-end <freq>        Chirp end frequency in Hz (default: 4000)" << std::endl;
+    std::cout << "  --sweep <s>               Chirp sweep time, repeated (default: 1)" << std::endl;
+    std::cout << "Network impairment (seeded, single stream):" << std::endl;
+    std::cout << "  --seed <n>                Random seed; every impaired run prints its seed for replay" << std::endl;
+    std::cout << "  --loss <p>                Drop each packet with probability <p>" << std::endl;
+    std::cout << "  --burst-loss <e>,<x>[,<l>] Gilbert-Elliott bursts: enter the bad state with probability" << std::endl;
+    std::cout << "                            <e>, leave it with <x>, losing <l> of its packets (default: 1)" << std::endl;
+    std::cout << "  --reorder <p>             Deliver a packet late with probability <p>" << std::endl;
+    std::cout << "  --reorder-depth <n>       Packets a reordered one arrives behind (default: 2)" << std::endl;
+    std::cout << "  --duplicate <p>           Send a second copy with probability <p>" << std::endl;
+    std::cout << "  --jitter <ms>             Random delay per packet, scale of the distribution" << std::endl;
+    std::cout << "  --jitter-dist <dist>      uniform (0..ms), normal (|N(0, ms)|), exponential or pareto" << std::endl;
+    std::cout << "                            (mean ms, heavy tail) (default: uniform)" << std::endl;
+    std::cout << "  --wrap-after <n>          Start the sequence number and timestamp <n> packets before they wrap" << std::endl;
+    std::cout << "Load generator (POSIX):" << std::endl;
+    std::cout << "  --streams <n>             Emulate <n> senders, each with its own sequence and timestamps" << std::endl;
+    std::cout << "  --rate <pps>              Aggregate packets per second (default: real time for every stream)" << std::endl;
+    std::cout << "  --batch <n>               Packets per sendmmsg call (Linux, default: 32)" << std::endl;
     std::cout << "  --help                   Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << programName << " localhost 8000" << std::endl;
     std::cout << "  " << programName << " 192.168.1.100 8000 --frequency 880" << std::endl;
     std::cout << "  " << programName << " localhost 8000 --sample-rate 44100 --packet-duration 0.01" << std::endl;
+    std::cout << "  " << programName << " localhost 8000 --signal chirp --frequency 100 --chirp-end 7000 --sweep 2" << std::endl;
+    std::cout << "  " << programName << " 127.0.0.1 8000 --burst-loss 0.02,0.3 --jitter 15 --jitter-dist pareto --seed 7" << std::endl;
+    std::cout << "  " << programName << " 127.0.0.1 8000 --streams 500 --rate 100000 --duration 30" << std::endl;
+}
+
+// Parse "--name value" within [min, max]; prints the error and returns false otherwise
+bool parseNumber(int& i, int argc, char* argv[], const std::string& name, double min, double max, double& value) {
+    if (i + 1 >= argc) {
+        std::cerr << "Error: " << name << " requires a value" << std::endl;
+        return false;
+    }
+    try {
+        value = std::stod(argv[++i]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid value for " << name << ": " << argv[i] << std::endl;
+        return false;
+    }
+    if (value < min || value > max) {
+        std::cerr << "Error: " << name << " must be between " << min << " and " << max << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Parse "--name value" as a whole integer within [min, max]
+bool parseInteger(int& i, int argc, char* argv[], const std::string& name, int min, int max, int& value) {
+    if (i + 1 >= argc) {
+        std::cerr << "Error: " << name << " requires a value" << std::endl;
+        return false;
+    }
+    std::string text = argv[++i];
+    size_t end = 0;
+    try {
+        value = std::stoi(text, &end);
+    } catch (const std::exception& e) {
+        end = 0;
+    }
+    if (end == 0 || end != text.size()) {
+        std::cerr << "Error: Invalid value for " << name << ": " << text << std::endl;
+        return false;
+    }
+    if (value < min || value > max) {
+        std::cerr << "Error: " << name << " must be between " << min << " and " << max << std::endl;
+        return false;
+    }
+    return true;
 }
 
 int main(int argc, char* argv[]) {
@@ -232,8 +1047,16 @@ int main(int argc, char* argv[]) {
     std::string host;
     int port = 0;
     int sampleRate = 16000;
-    double frequency = 440.0;
+    SignalConfig signal;
     double packetDuration = 0.02;
+    double duration = 0.0;
+    int streams = 0;
+    double rate = 0.0;
+    int batchSize = 32;
+    double spinUs = 0;
+    NetworkImpairment::Config impairment;
+    bool seedGiven = false;
+    int wrapAfter = 0;
 
     // Parse command line arguments
     if (argc < 3) {
@@ -268,8 +1091,8 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
             try {
-                frequency = std::stod(argv[++i]);
-                if (frequency <= 0) {
+                signal.frequency = std::stod(argv[++i]);
+                if (signal.frequency <= 0) {
                     std::cerr << "Error: Frequency must be positive" << std::endl;
                     return 1;
                 }
@@ -277,6 +1100,66 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Invalid frequency: " << argv[i] << std::endl;
                 return 1;
             }
+        } else if (arg == "--signal") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --signal requires a value" << std::endl;
+                return 1;
+            }
+            std::string type = argv[++i];
+            if (type == "tone") {
+                signal.type = SignalConfig::Type::Tone;
+            } else if (type == "white") {
+                signal.type = SignalConfig::Type::WhiteNoise;
+            } else if (type == "pink") {
+                signal.type = SignalConfig::Type::PinkNoise;
+            } else if (type == "chirp") {
+                signal.type = SignalConfig::Type::Chirp;
+            } else if (type == "multitone") {
+                signal.type = SignalConfig::Type::MultiTone;
+            } else {
+                std::cerr << "Error: Invalid signal: " << type << std::endl;
+                return 1;
+            }
+        } else if (arg == "--oscillator") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --oscillator requires a value" << std::endl;
+                return 1;
+            }
+            std::string oscillator = argv[++i];
+            if (oscillator == "table") {
+                signal.oscillator = SignalConfig::Oscillator::Wavetable;
+            } else if (oscillator == "recursive") {
+                signal.oscillator = SignalConfig::Oscillator::Recursive;
+            } else if (oscillator == "direct") {
+                signal.oscillator = SignalConfig::Oscillator::Direct;
+            } else {
+                std::cerr << "Error: Invalid oscillator: " << oscillator << std::endl;
+                return 1;
+            }
+        } else if (arg == "--frequencies") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --frequencies requires a value" << std::endl;
+                return 1;
+            }
+            std::istringstream list(argv[++i]);
+            std::string field;
+            signal.frequencies.clear();
+            try {
+                while (std::getline(list, field, ',')) {
+                    signal.frequencies.push_back(std::stod(field));
+                }
+            } catch (const std::exception& e) {
+                signal.frequencies.clear();
+            }
+            if (signal.frequencies.empty() ||
+                std::any_of(signal.frequencies.begin(), signal.frequencies.end(), [](double f) { return f <= 0.0; })) {
+                std::cerr << "Error: Invalid frequencies: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--chirp-end") {
+            if (!parseNumber(i, argc, argv, arg, 1.0, 1e6, signal.endFrequency)) return 1;
+        } else if (arg == "--sweep") {
+            if (!parseNumber(i, argc, argv, arg, 0.01, 3600.0, signal.sweepSeconds)) return 1;
         } else if (arg == "--packet-duration") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --packet-duration requires a value" << std::endl;
@@ -292,6 +1175,135 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Invalid packet duration: " << argv[i] << std::endl;
                 return 1;
             }
+        } else if (arg == "--duration") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --duration requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                duration = std::stod(argv[++i]);
+                if (duration <= 0) {
+                    std::cerr << "Error: Duration must be positive" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid duration: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--streams") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --streams requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                streams = std::stoi(argv[++i]);
+                if (streams < 1 || streams > 65536) {
+                    std::cerr << "Error: Streams must be between 1 and 65536" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid stream count: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--rate") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --rate requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                rate = std::stod(argv[++i]);
+                if (rate <= 0) {
+                    std::cerr << "Error: Rate must be positive" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid rate: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--batch") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --batch requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                batchSize = std::stoi(argv[++i]);
+                if (batchSize < 1 || batchSize > 1024) {
+                    std::cerr << "Error: Batch size must be between 1 and 1024" << std::endl;
+                    return 1;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid batch size: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--spin") {
+            if (!parseNumber(i, argc, argv, arg, 0, 10000, spinUs)) return 1;
+        } else if (arg == "--seed") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --seed requires a value" << std::endl;
+                return 1;
+            }
+            try {
+                impairment.seed = std::stoull(argv[++i]);
+                seedGiven = true;
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid seed: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--loss") {
+            if (!parseNumber(i, argc, argv, arg, 0.0, 1.0, impairment.lossRate)) return 1;
+        } else if (arg == "--burst-loss") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --burst-loss requires a value" << std::endl;
+                return 1;
+            }
+            // <enter>,<exit>[,<loss>]
+            std::istringstream spec(argv[++i]);
+            std::vector<double> values;
+            std::string field;
+            try {
+                while (std::getline(spec, field, ',')) {
+                    values.push_back(std::stod(field));
+                }
+            } catch (const std::exception& e) {
+                values.clear();
+            }
+            if (values.size() < 2 || values.size() > 3 ||
+                std::any_of(values.begin(), values.end(), [](double v) { return v < 0.0 || v > 1.0; }) ||
+                values[0] <= 0.0 || values[1] <= 0.0) {
+                std::cerr << "Error: Invalid burst loss: " << argv[i] << std::endl;
+                return 1;
+            }
+            impairment.burstEnter = values[0];
+            impairment.burstExit = values[1];
+            if (values.size() == 3) impairment.burstLoss = values[2];
+        } else if (arg == "--reorder") {
+            if (!parseNumber(i, argc, argv, arg, 0.0, 1.0, impairment.reorderRate)) return 1;
+        } else if (arg == "--reorder-depth") {
+            if (!parseInteger(i, argc, argv, arg, 1, 64, impairment.reorderDepth)) return 1;
+        } else if (arg == "--duplicate") {
+            if (!parseNumber(i, argc, argv, arg, 0.0, 1.0, impairment.duplicateRate)) return 1;
+        } else if (arg == "--jitter") {
+            if (!parseNumber(i, argc, argv, arg, 0.0, 10000.0, impairment.jitterMs)) return 1;
+        } else if (arg == "--jitter-dist") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --jitter-dist requires a value" << std::endl;
+                return 1;
+            }
+            std::string dist = argv[++i];
+            if (dist == "uniform") {
+                impairment.jitter = NetworkImpairment::Jitter::Uniform;
+            } else if (dist == "normal") {
+                impairment.jitter = NetworkImpairment::Jitter::Normal;
+            } else if (dist == "exponential") {
+                impairment.jitter = NetworkImpairment::Jitter::Exponential;
+            } else if (dist == "pareto") {
+                impairment.jitter = NetworkImpairment::Jitter::Pareto;
+            } else {
+                std::cerr << "Error: Invalid jitter distribution: " << dist << std::endl;
+                return 1;
+            }
+        } else if (arg == "--wrap-after") {
+            if (!parseInteger(i, argc, argv, arg, 1, 65535, wrapAfter)) return 1;
         } else if (host.empty()) {
             host = arg;
         } else if (port == 0) {
@@ -318,8 +1330,65 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (signal.frequencies.empty()) {
+        signal.frequencies.assign(std::begin(SignalConfig::DEFAULT_FREQUENCIES),
+                                  std::end(SignalConfig::DEFAULT_FREQUENCIES));
+    }
+    // Only the frequencies the chosen signal uses must be below Nyquist
+    double nyquist = sampleRate / 2.0;
+    std::vector<double> used;
+    if (signal.type == SignalConfig::Type::Tone || signal.type == SignalConfig::Type::Chirp) {
+        used.push_back(signal.frequency);
+    }
+    if (signal.type == SignalConfig::Type::Chirp) {
+        used.push_back(signal.endFrequency);
+    }
+    if (signal.type == SignalConfig::Type::MultiTone) {
+        used = signal.frequencies;
+    }
+    if (std::any_of(used.begin(), used.end(), [&](double f) { return f >= nyquist; })) {
+        std::cerr << "Error: Signal frequencies must be below half the sample rate (" << nyquist << " Hz)" << std::endl;
+        return 1;
+    }
+
+    // Print totals on Ctrl+C instead of dying mid-loop
+    installSignalHandlers();
+
+    if (streams > 0) {
+        if (impairment.lossRate > 0.0 || impairment.burstEnter > 0.0 || impairment.reorderRate > 0.0 ||
+            impairment.duplicateRate > 0.0 || impairment.jitterMs > 0.0 || wrapAfter > 0) {
+            std::cerr << "Error: Impairment options apply to a single stream, not --streams" << std::endl;
+            return 1;
+        }
+#ifndef _WIN32
+        LoadGenerator::Config config;
+        config.streams = static_cast<size_t>(streams);
+        config.packetsPerSecond = rate;
+        config.batchSize = static_cast<size_t>(batchSize);
+        config.durationSeconds = duration;
+        config.spin = std::chrono::microseconds(static_cast<int64_t>(spinUs));
+        LoadGenerator generator(host, port, sampleRate, signal, packetDuration, config);
+        return generator.run() ? 0 : 1;
+#else
+        std::cerr << "Error: --streams is not supported on Windows" << std::endl;
+        return 1;
+#endif
+    } else if (rate > 0.0) {
+        std::cerr << "Error: --rate requires --streams" << std::endl;
+        return 1;
+    }
+
     // Create and run sender
-    UDPTestSender sender(host, port, sampleRate, frequency, packetDuration);
+    // Every impaired run prints its seed, so its impairment pattern can be replayed
+    if (!seedGiven) {
+        impairment.seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    }
+
+    UDPTestSender sender(host, port, sampleRate, signal, packetDuration);
+    sender.setDuration(duration);
+    sender.setImpairment(impairment);
+    sender.setWrapAfter(wrapAfter);
+    sender.setSpin(std::chrono::microseconds(static_cast<int64_t>(spinUs)));
     sender.sendAudioPackets();
 
     return 0;